@@ -0,0 +1,255 @@
+#include <map>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <unistd.h>
+#include <algorithm>
+#include "cpp/shared/latency.hpp"
+
+/*
+ * Runs every problem binary non-interactively over a sweep of parameters, and reports throughput and latency percentiles as JSON or CSV.
+ *
+ * Usage: scenario_bench [binary directory] [json|csv] [trials] [warm-up runs] [scenario]
+ *
+ * The binaries are expected to be named after their sources (readers_writers, fifo_barbershop, ...).  Each run gets its parameters as
+ * command-line options, its own output is thrown away, and its latency_histograms come back through the file named by LATENCY_REPORT.
+ * Wall times include starting the process, so throughput is a lower bound.  Every configuration gets its warm-up runs (one by default)
+ * before its trials, and they're thrown away: every trial is a fresh process, so all they warm up is the page cache and the CPU clock.
+ * A run which exits non-zero (like a problem rejecting its parameters) fails its whole configuration, which is reported as failed
+ * with no trials.
+ */
+
+typedef std::chrono::steady_clock testing_clock;
+
+struct axis{
+	std::string name;
+	std::vector<int> values;
+};
+
+struct scenario{
+	std::string binary;
+	std::vector<axis> axes;				//Passed to the binary as --name=value options.
+	std::vector<int> work_axes;			//Throughput is the sum of these parameters (the number of actors, or n) per second.
+};
+
+struct result{
+	std::string name;
+	std::vector<int> parameters;
+	std::vector<long long> wall_times;
+	bool failed = false;
+	std::map<std::string, std::unique_ptr<latency_histogram>> latencies;
+};
+
+std::vector<scenario> all_scenarios(){
+	return {
+		{"readers_writers", {{"readers", {200}}, {"writers", {20}}, {"workers", {0, 2, 8}}}, {0, 1}},
+		{"fifo_barbershop", {{"customers", {500}}, {"chairs", {5, 50}}, {"workers", {0, 4}}, {"coroutines", {0, 1}}, {"queue", {0, 1}}}, {0}},
+		{"roller_coaster", {{"passengers", {1000}}, {"cars", {4}}, {"seats", {10, 50}}, {"workers", {0, 4}}, {"coroutines", {0, 1}}}, {0}},
+		{"search_insert_delete", {{"searchers", {100, 400}}, {"inserters", {100}}, {"deleters", {50, 200}}, {"workers", {0, 4}}, {"backend", {0, 1, 2, 3, 4, 5}}}, {0, 1, 2}},
+		{"faneuil_hall", {{"immigrants", {50}}, {"spectators", {20}}, {"workers", {0, 4}}}, {0, 1}},
+		{"sieve_of_eratosthenes", {{"n", {2000, 20000}}, {"workers", {0, 4}}, {"output", {0}}, {"sieve", {0, 1, 2, 3}}, {"primes_per_stage", {16}}}, {0}}
+	};
+}
+
+//Every combination of the scenario's parameters, first axis slowest.
+std::vector<std::vector<int>> sweep(const scenario& s){
+	std::vector<std::vector<int>> combinations(1);
+	for(auto a = s.axes.begin(); a != s.axes.end(); ++a){
+		std::vector<std::vector<int>> extended;
+		for(auto c = combinations.begin(); c != combinations.end(); ++c){
+			for(auto v = a->values.begin(); v != a->values.end(); ++v){
+				extended.push_back(*c);
+				extended.back().push_back(*v);
+			}
+		}
+		combinations.swap(extended);
+	}
+	return combinations;
+}
+
+//Runs the binary once, and returns its wall time in nanoseconds (or -1 if it failed).
+long long run_once(const scenario& s, const std::vector<int>& parameters, const std::string& directory, const std::string& report){
+	std::ofstream(report, std::ios::trunc);
+	
+	std::string command = "LATENCY_REPORT='" + report + "' '" + directory + "/" + s.binary + "'";
+	for(std::size_t i = 0; i < parameters.size(); ++i){
+		command += " --" + s.axes[i].name + "=" + std::to_string(parameters[i]);
+	}
+	command += " < /dev/null > /dev/null";
+	testing_clock::time_point start = testing_clock::now();
+	
+	int status = std::system(command.c_str());
+	
+	long long wall = std::chrono::duration_cast<std::chrono::nanoseconds>(testing_clock::now() - start).count();
+	return status == 0 ? wall : -1;
+}
+
+void collect(const std::string& report, result& r){
+	std::ifstream in(report);
+	std::string line;
+	while(std::getline(in, line)){
+		std::string label = line.substr(0, line.find(' '));
+		std::unique_ptr<latency_histogram>& h = r.latencies[label];
+		if(!h){
+			h.reset(new latency_histogram(NULL, false));
+		}
+		std::stringstream fields(line);
+		h->read(fields);
+	}
+}
+
+long long median(std::vector<long long> values){
+	std::sort(values.begin(), values.end());
+	return values.empty() ? 0 : values[values.size() / 2];
+}
+
+double throughput(const scenario& s, const result& r){
+	long long work = 0;
+	for(auto i = s.work_axes.begin(); i != s.work_axes.end(); ++i){
+		work += r.parameters[*i];
+	}
+	long long wall = median(r.wall_times);
+	return wall > 0 ? work * 1e9 / wall : 0;
+}
+
+
+
+//----------Output Functions----------
+
+void write_json(const std::vector<scenario>& scenarios, const std::vector<std::pair<int, result>>& results){
+	std::cout << "[\n";
+	for(auto i = results.begin(); i != results.end(); ++i){
+		const scenario& s = scenarios[i->first];
+		const result& r = i->second;
+		
+		std::cout << "\t{\"scenario\": \"" << r.name << "\", \"parameters\": {";
+		for(std::size_t j = 0; j < s.axes.size(); ++j){
+			std::cout << (j > 0 ? ", " : "") << "\"" << s.axes[j].name << "\": " << r.parameters[j];
+		}
+		std::cout << "}, \"trials\": " << r.wall_times.size() << ", \"failed\": " << (r.failed ? "true" : "false");
+		if(!r.wall_times.empty()){
+			std::cout << ", \"wall_ns\": {\"min\": " << *std::min_element(r.wall_times.begin(), r.wall_times.end())
+					  << ", \"median\": " << median(r.wall_times)
+					  << ", \"max\": " << *std::max_element(r.wall_times.begin(), r.wall_times.end()) << "}";
+		}
+		std::cout << ", \"throughput_per_s\": " << throughput(s, r) << ", \"latency_ns\": {";
+		for(auto h = r.latencies.begin(); h != r.latencies.end(); ++h){
+			std::cout << (h != r.latencies.begin() ? ", " : "") << "\"" << h->first << "\": {\"count\": " << h->second->count()
+					  << ", \"p50\": " << h->second->percentile(50) << ", \"p99\": " << h->second->percentile(99)
+					  << ", \"p999\": " << h->second->percentile(99.9) << ", \"max\": " << h->second->max() << "}";
+		}
+		std::cout << "}}" << (i + 1 != results.end() ? "," : "") << "\n";
+	}
+	std::cout << "]\n";
+}
+
+void write_csv(const std::vector<scenario>& scenarios, const std::vector<std::pair<int, result>>& results){
+	std::cout << "scenario,parameters,trials,failed,wall_min_ns,wall_median_ns,wall_max_ns,throughput_per_s,histogram,count,p50_ns,p99_ns,p999_ns,max_ns\n";
+	for(auto i = results.begin(); i != results.end(); ++i){
+		const scenario& s = scenarios[i->first];
+		const result& r = i->second;
+		
+		std::stringstream prefix;
+		prefix << r.name << ",";
+		for(std::size_t j = 0; j < s.axes.size(); ++j){
+			prefix << (j > 0 ? ";" : "") << s.axes[j].name << "=" << r.parameters[j];
+		}
+		prefix << "," << r.wall_times.size() << "," << (r.failed ? 1 : 0);
+		if(!r.wall_times.empty()){
+			prefix << "," << *std::min_element(r.wall_times.begin(), r.wall_times.end()) << "," << median(r.wall_times)
+				   << "," << *std::max_element(r.wall_times.begin(), r.wall_times.end());
+		}else{
+			prefix << ",,,";
+		}
+		prefix << "," << throughput(s, r);
+		
+		if(r.latencies.empty()){
+			std::cout << prefix.str() << ",,,,,,\n";
+		}
+		for(auto h = r.latencies.begin(); h != r.latencies.end(); ++h){
+			std::cout << prefix.str() << "," << h->first << "," << h->second->count() << "," << h->second->percentile(50) << ","
+					  << h->second->percentile(99) << "," << h->second->percentile(99.9) << "," << h->second->max() << "\n";
+		}
+	}
+}
+
+
+
+//----------Benchmark Functions----------
+
+void test_scenario(const std::string& directory, bool json, int trials, int warmups, const std::string& only){
+	std::vector<scenario> scenarios = all_scenarios();
+	std::vector<std::pair<int, result>> results;
+	
+	char report[] = "/tmp/scenario_bench.XXXXXX";
+	int fd = mkstemp(report);
+	if(fd < 0){
+		std::cerr << "Could not create a temporary file for the latency reports.\n";
+		return;
+	}
+	close(fd);
+	
+	for(std::size_t i = 0; i < scenarios.size(); ++i){
+		const scenario& s = scenarios[i];
+		if(!only.empty() && only != s.binary){
+			continue;
+		}
+		
+		std::vector<std::vector<int>> configurations = sweep(s);
+		for(auto c = configurations.begin(); c != configurations.end(); ++c){
+			results.emplace_back(i, result());
+			result& r = results.back().second;
+			r.name = s.binary;
+			r.parameters = *c;
+			
+			std::cerr << "(" << s.binary << ")";
+			for(std::size_t j = 0; j < s.axes.size(); ++j){
+				std::cerr << " " << s.axes[j].name << "=" << (*c)[j];
+			}
+			std::cerr << "\n";
+			
+			for(int t = 0; t < warmups + trials; ++t){
+				long long wall = run_once(s, *c, directory, report);
+				if(wall < 0){
+					std::cerr << "(" << s.binary << ") Run failed, skipping the rest of this configuration.\n";
+					r.failed = true;		//Whatever it did get through doesn't count either.
+					r.wall_times.clear();
+					r.latencies.clear();
+					break;
+				}
+				if(t >= warmups){
+					r.wall_times.push_back(wall);
+					collect(report, r);
+				}
+			}
+		}
+	}
+	std::remove(report);
+	
+	if(json){
+		write_json(scenarios, results);
+	}else{
+		write_csv(scenarios, results);
+	}
+}
+
+int main(int argc, char* argv[]){
+	std::string directory = argc > 1 ? argv[1] : ".";
+	std::string format = argc > 2 ? argv[2] : "json";
+	int trials = argc > 3 ? std::atoi(argv[3]) : 5;
+	int warmups = argc > 4 ? std::atoi(argv[4]) : 1;
+	std::string only = argc > 5 ? argv[5] : "";
+	
+	if((format != "json" && format != "csv") || trials < 1 || warmups < 0){
+		std::cerr << "Usage: " << argv[0] << " [binary directory] [json|csv] [trials >= 1] [warm-up runs >= 0] [scenario]\n";
+		return 1;
+	}
+	test_scenario(directory, format == "json", trials, warmups, only);
+	return 0;
+}
\ No newline at end of file
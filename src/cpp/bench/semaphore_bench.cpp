@@ -0,0 +1,108 @@
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <iostream>
+#include <stdexcept>
+#include <functional>
+#include "cpp/shared/parse.hpp"
+#include "cpp/shared/semaphore.hpp"
+
+typedef std::chrono::steady_clock testing_clock;
+
+//Signals and then immediately waits, so the count never hits zero and nobody ever sleeps.
+template <class Semaphore>
+long long uncontended(int iterations){
+	Semaphore sem(0);
+	
+	testing_clock::time_point start = testing_clock::now();
+	for(int i = 0; i < iterations; ++i){
+		sem.signal();
+		sem.wait();
+	}
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(testing_clock::now() - start).count();
+}
+
+//Two threads hand a single permit back and forth, so every wait has to block.
+template <class Semaphore>
+long long ping_pong(int iterations){
+	Semaphore ping(0);
+	Semaphore pong(0);
+	
+	testing_clock::time_point start = testing_clock::now();
+	std::thread other([&](){
+		for(int i = 0; i < iterations; ++i){
+			ping.wait();
+			pong.signal();
+		}
+	});
+	for(int i = 0; i < iterations; ++i){
+		ping.signal();
+		pong.wait();
+	}
+	if(other.joinable()){
+		other.join();
+	}
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(testing_clock::now() - start).count();
+}
+
+//Several producers signal while the same number of consumers wait on one semaphore.
+template <class Semaphore>
+long long contended(int iterations, int pairs){
+	Semaphore sem(0);
+	std::vector<std::thread> threads;
+	
+	testing_clock::time_point start = testing_clock::now();
+	for(int i = 0; i < pairs; ++i){
+		threads.push_back(std::thread([&](){
+			for(int j = 0; j < iterations; ++j){
+				sem.signal();
+			}
+		}));
+		threads.push_back(std::thread([&](){
+			for(int j = 0; j < iterations; ++j){
+				sem.wait();
+			}
+		}));
+	}
+	for(auto i = threads.begin(); i != threads.end(); ++i){
+		if(i->joinable()){
+			i->join();
+		}
+	}
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(testing_clock::now() - start).count();
+}
+
+template <class Semaphore>
+void run_all(const std::string& name, int iterations, int pairs){
+	std::cout << name << " uncontended: " << uncontended<Semaphore>(iterations) / iterations << " ns/op\n";
+	std::cout << name << " ping-pong:   " << ping_pong<Semaphore>(iterations) / iterations << " ns/round trip\n";
+	std::cout << name << " contended:   " << contended<Semaphore>(iterations, pairs) / (static_cast<long long>(iterations) * pairs) << " ns/op\n";
+}
+
+void test_scenario(int iterations, int pairs){
+	run_all<locking_semaphore>("(locking_semaphore)", iterations, pairs);
+	run_all<semaphore>("(semaphore)        ", iterations, pairs);
+}
+
+int main(){
+	try{
+		std::cout << "Please input how many iterations to run: ";
+		int iterations = scan_int();
+		if(iterations > 0){
+			std::cout << "Please input how many producer/consumer pairs to run: ";
+			int pairs = scan_int();
+			if(pairs > 0){
+				test_scenario(iterations, pairs);
+			}else{
+				throw std::invalid_argument("Read a value less than one from std::cin.");
+			}
+		}else{
+			throw std::invalid_argument("Read a value less than one from std::cin.");
+		}
+	}catch(const std::invalid_argument& ex){
+		std::cout << ex.what() << "\nPlease input a single positive integer, and nothing else.";
+		return 1;
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include "cpp/shared/parse.hpp"
+#include "cpp/shared/lf_list.hpp"
+#include "cpp/shared/container.hpp"
+#include "cpp/shared/shard_set.hpp"
+#include "cpp/shared/skip_list.hpp"
+#include "cpp/shared/fine_list.hpp"
+
+/*
+ * Measures the concurrent set backends under contention: a fixed number of threads hammer one set over a fixed key space
+ * for a fixed time, with a given mix of searches, inserts and removes.  The requests are generated before the clock starts,
+ * so the measured part is nothing but set operations (and a look at the clock every so often).
+ *
+ * Usage: set_bench [--threads t] [--keys k] [--milliseconds m] [--backend b] [--seed s]
+ *
+ * Without --threads it runs 1, 2, 4 and 8 threads, and without --backend every backend (numbered like search_insert_delete's).
+ * The set starts half full, and inserts and removes are equally likely, so it stays about half full throughout
+ * (except for backend 0, search_insert_delete's coarse-locked container, whose inserts don't check for duplicates).
+ * Timing a fixed stretch rather than a fixed number of operations keeps the lists, which are hundreds of times slower, affordable.
+ */
+
+typedef std::chrono::steady_clock testing_clock;
+
+struct mix{
+	const char* name;
+	int search_percent;
+	int insert_percent;		//Whatever's left over is removes.
+};
+
+enum operation : std::uint8_t {do_search, do_insert, do_remove};
+
+struct request{
+	operation op;
+	int key;
+};
+
+constexpr std::size_t requests_per_thread = 1 << 16;		//Cycled through until time's up.
+constexpr int clock_period = 64;						//Operations between looks at the clock.
+
+//xorshift64*, high half only: the low bits of consecutive xorshift64 values are tied together, which would tie each key to one operation.
+std::uint64_t next_random(std::uint64_t& state){
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return (state * 0x2545f4914f6cdd1dULL) >> 32;
+}
+
+//Runs every thread until the time is up, and returns how many million operations they got through per second, all together.
+template <class Set>
+double run_once(int threads, int keys, std::chrono::milliseconds duration, const mix& m, std::uint64_t seed){
+	Set set;
+	std::uint64_t state = seed | 1;
+	for(int i = 0; i < keys; ++i){
+		if(next_random(state) % 2 == 0){
+			set.insert(i);
+		}
+	}
+	
+	std::vector<std::vector<request>> requests(threads);
+	for(int t = 0; t < threads; ++t){
+		for(std::size_t i = 0; i < requests_per_thread; ++i){
+			int roll = next_random(state) % 100;
+			int key = next_random(state) % keys;
+			operation op = roll < m.search_percent ? do_search : roll < m.search_percent + m.insert_percent ? do_insert : do_remove;
+			requests[t].push_back({op, key});
+		}
+	}
+	
+	std::atomic<int> ready(0);
+	std::atomic<bool> go(false);
+	std::atomic<long long> completed(0);
+	std::atomic<long long> hits(0);		//Keeps the searches from being optimized away.
+	testing_clock::time_point deadline;
+	std::vector<std::thread> workers;
+	for(int t = 0; t < threads; ++t){
+		workers.push_back(std::thread([&, t](){
+			ready.fetch_add(1);
+			while(!go.load(std::memory_order_acquire)){
+				std::this_thread::yield();
+			}
+			
+			long long done = 0;
+			long long succeeded = 0;
+			std::size_t next = 0;
+			do{
+				for(int i = 0; i < clock_period; ++i){
+					const request& r = requests[t][next];
+					if(r.op == do_search){
+						succeeded += set.contains(r.key);
+					}else if(r.op == do_insert){
+						succeeded += set.insert(r.key);
+					}else{
+						succeeded += set.remove(r.key);
+					}
+					next = (next + 1) % requests_per_thread;
+				}
+				done += clock_period;
+			}while(testing_clock::now() < deadline);
+			completed.fetch_add(done);
+			hits.fetch_add(succeeded);
+		}));
+	}
+	while(ready.load() < threads){
+		std::this_thread::yield();
+	}
+	
+	testing_clock::time_point start = testing_clock::now();
+	deadline = start + duration;
+	go.store(true, std::memory_order_release);		//Publishes the deadline too.
+	for(auto i = workers.begin(); i != workers.end(); ++i){
+		i->join();
+	}
+	long long wall = std::chrono::duration_cast<std::chrono::nanoseconds>(testing_clock::now() - start).count();		//A little past the deadline.
+	return completed.load() * 1000.0 / wall;
+}
+
+template <class Set>
+void run_all(const std::string& name, const std::vector<int>& thread_counts, int keys, std::chrono::milliseconds duration, std::uint64_t seed){
+	const mix mixes[] = {{"90/5/5", 90, 5}, {"50/25/25", 50, 25}, {"0/50/50", 0, 50}};
+	for(const mix& m : mixes){
+		for(auto t = thread_counts.begin(); t != thread_counts.end(); ++t){
+			std::cout << name << " " << m.name << " search/insert/remove, " << *t << " threads: " << run_once<Set>(*t, keys, duration, m, seed) << " Mops/s\n";
+		}
+	}
+}
+
+void test_scenario(const std::vector<int>& thread_counts, int keys, std::chrono::milliseconds duration, int backend, std::uint64_t seed){
+	if(backend < 0 || backend == 0){
+		run_all<container>("(container)   ", thread_counts, keys, duration, seed);
+	}
+	if(backend < 0 || backend == 1){
+		run_all<lf_list<int>>("(lf_list)     ", thread_counts, keys, duration, seed);
+	}
+	if(backend < 0 || backend == 2){
+		run_all<shard_set<int>>("(shard_set)   ", thread_counts, keys, duration, seed);
+	}
+	if(backend < 0 || backend == 3){
+		run_all<skip_list<int>>("(skip_list)   ", thread_counts, keys, duration, seed);
+	}
+	if(backend < 0 || backend == 4){
+		run_all<coupled_list<int>>("(coupled_list)", thread_counts, keys, duration, seed);
+	}
+	if(backend < 0 || backend == 5){
+		run_all<lazy_list<int>>("(lazy_list)   ", thread_counts, keys, duration, seed);
+	}
+}
+
+int main(int argc, char* argv[]){
+	try{
+		parse_args(argc, argv, {"threads", "keys", "milliseconds", "backend"});
+		int threads = arg_or("threads", 0);
+		int keys = arg_or("keys", 16384);
+		long long milliseconds = arg_or("milliseconds", 200);
+		int backend = arg_or("backend", -1);
+		if(threads >= 0){
+			if(keys > 0){
+				if(milliseconds > 0){
+					if(backend <= 5){
+						std::vector<int> thread_counts;
+						if(threads == 0){
+							thread_counts = {1, 2, 4, 8};
+						}else{
+							thread_counts.push_back(threads);
+						}
+						test_scenario(thread_counts, keys, std::chrono::milliseconds(milliseconds), backend, arg_or("seed", 1));
+					}else{
+						throw std::invalid_argument("Read an unknown backend for --backend.");
+					}
+				}else{
+					throw std::invalid_argument("Read a value less than one for --milliseconds.");
+				}
+			}else{
+				throw std::invalid_argument("Read a value less than one for --keys.");
+			}
+		}else{
+			throw std::invalid_argument("Read a negative value for --threads.");
+		}
+	}catch(const std::invalid_argument& ex){
+		std::cout << ex.what() << "\nUsage: set_bench [--threads t] [--keys k] [--milliseconds m] [--backend 0-5] [--seed s]\n";
+		return 1;
+	}
+	return 0;
+}
\ No newline at end of file
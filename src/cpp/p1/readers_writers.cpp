@@ -1,4 +1,5 @@
 #include <mutex>
+#include <memory>
 #include <thread>
 #include <vector>
 #include <chrono>
@@ -7,114 +8,104 @@
 #include <stdexcept>
 #include <shared_mutex>
 #include "cpp/shared/parse.hpp"
+#include "cpp/shared/latency.hpp"
+#include "cpp/shared/event_log.hpp"
+#include "cpp/shared/thread_pool.hpp"
 
 typedef std::chrono::steady_clock testing_clock;
 
-std::mutex output_mutex;	//This protects std::cout while the readers/writers are working.
+latency_histogram reader_wait("reader_wait");		//How long each reader waits for the lock.
+latency_histogram writer_wait("writer_wait");
 
 void reader(int id, int* data, std::shared_mutex* lock){
-	//testing_clock::time_point start = testing_clock::now();
+	testing_clock::time_point start = testing_clock::now();
 	lock->lock_shared();
-	//testing_clock::time_point end = testing_clock::now();
+	reader_wait.record_since(start);
 	
-	output_mutex.lock();
-	std::cout << "(Reader " << id << ") Begins reading...\n";
-	output_mutex.unlock();
+	log_event("(Reader %d) Begins reading...\n", id);
 	
-	std::this_thread::sleep_for(std::chrono::milliseconds(std::rand() % 10));
+	blocking_sleep_for(std::chrono::milliseconds(std::rand() % 10));
 	
 	int value = *data;
 	++value;
 	
-	output_mutex.lock();
-	std::cout << "(Reader " << id << ") Read " << *data << ".\n";
-	output_mutex.unlock();
+	log_event("(Reader %d) Read %d.\n", id, *data);
 	
 	lock->unlock_shared();
-	
-	/*output_mutex.lock();
-	std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << "\n";
-	output_mutex.unlock();*/
 }
 
 void writer(int id, int* data, std::shared_mutex* lock){
-	//testing_clock::time_point start = testing_clock::now();
+	testing_clock::time_point start = testing_clock::now();
 	lock->lock();
-	//testing_clock::time_point end = testing_clock::now();
+	writer_wait.record_since(start);
 	
-	output_mutex.lock();
-	std::cout << "(Writer " << id << ") Begins writing...\n";
-	output_mutex.unlock();
+	log_event("(Writer %d) Begins writing...\n", id);
 	
-	std::this_thread::sleep_for(std::chrono::milliseconds(std::rand() % 10));
+	blocking_sleep_for(std::chrono::milliseconds(std::rand() % 10));
 	
 	*data = *data + 1;
 	
-	output_mutex.lock();
-	std::cout << "(Writer " << id << ") Wrote " << *data << ".\n";
-	output_mutex.unlock();
+	log_event("(Writer %d) Wrote %d.\n", id, *data);
 	
 	lock->unlock();
-	
-	/*output_mutex.lock();
-	std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << "\n";
-	output_mutex.unlock();*/
 }
 
-void test_scenario(int total_readers, int total_writers){
+void test_scenario(int total_readers, int total_writers, int workers){
 	int data = 0;
 	std::shared_mutex lock;
 	
-	std::vector<std::thread> readers(total_readers);
-	std::vector<std::thread> writers(total_writers);
+	std::unique_ptr<thread_pool> pool(workers > 0 ? new thread_pool(workers) : NULL);
+	actor_group readers(pool.get());
+	actor_group writers(pool.get());
 	
 	for(int i = 0, j = 0; i < total_readers || j < total_writers;){
 		std::this_thread::sleep_for(std::chrono::milliseconds(std::rand() % 5));
 		if(i < total_readers && j < total_writers){
 			if(std::rand() % 2 == 0){
-				readers.push_back(std::thread(reader, i++, &data, &lock));
+				readers.spawn(reader, i++, &data, &lock);
 			}else{
-				writers.push_back(std::thread(writer, j++, &data, &lock));
+				writers.spawn(writer, j++, &data, &lock);
 			}
 		}else if(i < total_readers){
-			readers.push_back(std::thread(reader, i++, &data, &lock));
+			readers.spawn(reader, i++, &data, &lock);
 		}else if(j < total_writers){
-			writers.push_back(std::thread(writer, j++, &data, &lock));
+			writers.spawn(writer, j++, &data, &lock);
 		}
 	}
 	
-	for(auto i = readers.begin(); i != readers.end(); ++i){
-		if(i->joinable()){
-			i->join();
-		}
-	}
-	for(auto i = writers.begin(); i != writers.end(); ++i){
-		if(i->joinable()){
-			i->join();
-		}
-	}
+	readers.join();
+	writers.join();
 	
 	//std::cout << "Final value: " << data << "\n";
 }
 
-int main(){
-	std::srand(std::time(0));
+int main(int argc, char* argv[]){
 	try{
-		std::cout << "Please input how many reader threads to run: ";
-		int readers = scan_int();
+		parse_args(argc, argv, {"readers", "writers", "workers"});
+		std::srand(arg_or("seed", std::time(0)));
+		long long repeat = arg_or("repeat", 1);
+		int readers = arg_int("readers", "Please input how many reader threads to run: ");
 		if(readers >= 0){
-			std::cout << "Please input how many writer threads to run: ";
-			int writers = scan_int();
+			int writers = arg_int("writers", "Please input how many writer threads to run: ");
 			if(writers >= 0){
-				test_scenario(readers, writers);
+				int workers = arg_int("workers", "Please input how many worker threads to run the actors on (0 for one thread per actor): ");
+				if(workers >= 0){
+					for(long long run = 0; run < repeat; ++run){
+						test_scenario(readers, writers, workers);
+					}
+				}else{
+					throw std::invalid_argument("Read a negative value for --workers.");
+				}
 			}else{
-				throw std::invalid_argument("Read a negative value from std::cin.");
+				throw std::invalid_argument("Read a negative value for --writers.");
 			}
 		}else{
-			throw std::invalid_argument("Read a negative value from std::cin.");
+			throw std::invalid_argument("Read a negative value for --readers.");
 		}
 	}catch(const std::invalid_argument& ex){
-		std::cout << "Please input a single natural number, and nothing else.\n";
+		std::cout << ex.what() << "\nUsage: readers_writers [--readers n] [--writers n] [--workers n] [--seed s] [--repeat n]\n";
+		return 1;
 	}
+	write_latency_report();
 	return 0;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <mutex>
+#include <memory>
 #include <vector>
 #include <thread>
 #include <chrono>
@@ -6,12 +7,18 @@
 #include <iostream>
 #include <functional>
 #include "cpp/shared/parse.hpp"
+#include "cpp/shared/latency.hpp"
+#include "cpp/shared/lf_queue.hpp"
+#include "cpp/shared/coroutine.hpp"
 #include "cpp/shared/ts_queue.hpp"
+#include "cpp/shared/event_log.hpp"
 #include "cpp/shared/semaphore.hpp"
+#include "cpp/shared/thread_pool.hpp"
 
 typedef std::chrono::steady_clock testing_clock;
 
-std::mutex output_mutex;
+latency_histogram customer_wait("customer_wait");	//How long each seated customer waits to be called up.
+latency_histogram scenario_time("scenario");
 
 struct customer_info{
 	customer_info(int i = 0, semaphore* s = NULL) : id(i), sem(s) {}
@@ -20,61 +27,55 @@ struct customer_info{
 	semaphore* sem;
 };
 
-void customer(int id, ts_queue<customer_info>& queue){
+template <class Queue>
+void customer(int id, Queue& queue){
 	semaphore sem;
 	customer_info info(id, &sem);
-	std::this_thread::sleep_for(std::chrono::milliseconds(std::rand() % 100));	//Walk to the barbershop...
+	blocking_sleep_for(std::chrono::milliseconds(std::rand() % 100));	//Walk to the barbershop...
 	
+	testing_clock::time_point start = testing_clock::now();
 	if(queue.enqueue(info)){	//Shop is not full, enter.
-		output_mutex.lock();
-		std::cout << "(Customer " << id << ") Arrives.\n";	//This isn't perfect, one thread could get the lock first, even though the other go into the queue first.
-		output_mutex.unlock();
+		log_event("(Customer %d) Arrives.\n", id);	//This isn't perfect, one thread could get the lock first, even though the other go into the queue first.
 		
 		sem.wait();	//Wait until barber calls you up.
+		customer_wait.record_since(start);
 		//Get hair cut...
 		sem.wait();	//Wait until barber is done.
 	}else{
-		output_mutex.lock();
-		std::cout << "(Customer " << id << ") The shop is full!\n";		//Shop is full, balk and leave.
-		output_mutex.unlock();
+		log_event("(Customer %d) The shop is full!\n", id);		//Shop is full, balk and leave.
 	}
 }
 
-void barber(ts_queue<customer_info>& queue){
+template <class Queue>
+void barber(Queue& queue){
 	customer_info next;
 	while(queue.dequeue(next)){	//Wait for a customer.
 		next.sem->signal();	//Call customer up.
 		
-		output_mutex.lock();
-		std::cout << "(Barber) Customer " << next.id << "!\n";
-		output_mutex.unlock();
-		std::this_thread::sleep_for(std::chrono::milliseconds(std::rand() % 10));	//Cut their hair...
-		output_mutex.lock();
-		std::cout << "(Barber) All done, customer " << next.id << ".\n";
-		output_mutex.unlock();
+		log_event("(Barber) Customer %d!\n", next.id);
+		blocking_sleep_for(std::chrono::milliseconds(std::rand() % 10));	//Cut their hair...
+		log_event("(Barber) All done, customer %d.\n", next.id);
 		
 		next.sem->signal();	//Tell customer they're done.
 	}
 }
 
-void test_scenario(int total_customers, int shop_capacity){
-	ts_queue<customer_info> queue(shop_capacity);
+template <class Queue = ts_queue<customer_info>>		//Either ts_queue<customer_info> or lf_queue<customer_info>.
+void test_scenario(int total_customers, int shop_capacity, int workers){
+	Queue queue(shop_capacity);
+	std::unique_ptr<thread_pool> pool(workers > 0 ? new thread_pool(workers) : NULL);
 	
-	//testing_clock::time_point start = testing_clock::now();
+	testing_clock::time_point start = testing_clock::now();
 	
-	std::thread barber_thread(barber, std::ref(queue));
-	std::vector<std::thread> customers(total_customers);
+	std::thread barber_thread(barber<Queue>, std::ref(queue));
+	actor_group customers(pool.get());
 	for(int i = 0; i < total_customers; ++i){
-		customers.push_back(std::thread(customer, i, std::ref(queue)));
+		customers.spawn(customer<Queue>, i, std::ref(queue));
 	}
 	
-	for(auto i = customers.begin(); i != customers.end(); ++i){
-		if(i->joinable()){
-			i->join();
-		}
-	}
+	customers.join();
 	
-	//std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(testing_clock::now() - start).count() << "\n";
+	scenario_time.record_since(start);
 	
 	queue.close();
 	if(barber_thread.joinable()){
@@ -82,24 +83,115 @@ void test_scenario(int total_customers, int shop_capacity){
 	}
 }
 
-int main(){
-	std::srand(std::time(0));
+
+
+//----------Coroutine Functions----------
+
+struct co_customer_info{
+	co_customer_info(int i = 0, co_semaphore* s = NULL) : id(i), sem(s) {}
+	
+	int id;
+	co_semaphore* sem;
+};
+
+co_task co_customer(int id, co_queue<co_customer_info>& queue, co_semaphore& done){
+	co_semaphore sem;
+	co_await co_sleep_for(std::chrono::milliseconds(std::rand() % 100));	//Walk to the barbershop...
+	
+	testing_clock::time_point start = testing_clock::now();
+	if(queue.enqueue(co_customer_info(id, &sem))){	//Shop is not full, enter.
+		log_event("(Customer %d) Arrives.\n", id);
+		
+		co_await sem.wait();	//Wait until barber calls you up.
+		customer_wait.record_since(start);
+		//Get hair cut...
+		co_await sem.wait();	//Wait until barber is done.
+	}else{
+		log_event("(Customer %d) The shop is full!\n", id);		//Shop is full, balk and leave.
+	}
+	done.signal();
+}
+
+co_task co_barber(co_queue<co_customer_info>& queue){
+	co_customer_info next;
+	while(co_await queue.dequeue(next)){	//Wait for a customer.
+		next.sem->signal();	//Call customer up.
+		
+		log_event("(Barber) Customer %d!\n", next.id);
+		co_await co_sleep_for(std::chrono::milliseconds(std::rand() % 10));	//Cut their hair...
+		log_event("(Barber) All done, customer %d.\n", next.id);
+		
+		next.sem->signal();	//Tell customer they're done.
+	}
+}
+
+co_task co_street(int total_customers, co_queue<co_customer_info>& queue, co_scheduler& scheduler){
+	co_semaphore done;
+	for(int i = 0; i < total_customers; ++i){
+		scheduler.spawn(co_customer(i, queue, done));
+	}
+	
+	co_await done.wait(total_customers);
+	queue.close();
+}
+
+void co_test_scenario(int total_customers, int shop_capacity, int workers){
+	co_queue<co_customer_info> queue(shop_capacity);
+	co_scheduler scheduler(workers);
+	
+	testing_clock::time_point start = testing_clock::now();
+	
+	scheduler.spawn(co_barber(queue));
+	scheduler.spawn(co_street(total_customers, queue, scheduler));
+	scheduler.run();
+	
+	scenario_time.record_since(start);
+}
+
+int main(int argc, char* argv[]){
 	try{
-		std::cout << "Please input how many customers to run: ";
-		int customers = scan_int();
+		parse_args(argc, argv, {"customers", "chairs", "workers", "coroutines", "queue"});
+		std::srand(arg_or("seed", std::time(0)));
+		long long repeat = arg_or("repeat", 1);
+		long long queue = arg_or("queue", 0);		//Which queue the threads share, 0 for ts_queue or 1 for lf_queue.  Coroutines always use co_queue.
+		if(queue != 0 && queue != 1){
+			throw std::invalid_argument("Read a value other than zero or one for --queue.");
+		}
+		int customers = arg_int("customers", "Please input how many customers to run: ");
 		if(customers >= 0){
-			std::cout << "Please input how many chairs there are in the barbershop's waiting room: ";
-			int capacity = scan_int();
+			int capacity = arg_int("chairs", "Please input how many chairs there are in the barbershop's waiting room: ");
 			if(capacity >= 0){
-				test_scenario(customers, capacity);
+				int workers = arg_int("workers", "Please input how many worker threads to run the actors on (0 for one thread per actor): ");
+				if(workers >= 0){
+					int coroutines = arg_int("coroutines", "Please input 1 to run the actors as coroutines, or 0 to run them as threads: ");
+					if(coroutines == 1){
+						for(long long run = 0; run < repeat; ++run){
+							co_test_scenario(customers, capacity, workers);
+						}
+					}else if(coroutines == 0){
+						for(long long run = 0; run < repeat; ++run){
+							if(queue == 1){
+								test_scenario<lf_queue<customer_info>>(customers, capacity, workers);
+							}else{
+								test_scenario<ts_queue<customer_info>>(customers, capacity, workers);
+							}
+						}
+					}else{
+						throw std::invalid_argument("Read a value other than zero or one for --coroutines.");
+					}
+				}else{
+					throw std::invalid_argument("Read a negative value for --workers.");
+				}
 			}else{
-				throw std::invalid_argument("Read a negative value from std::cin.");
+				throw std::invalid_argument("Read a negative value for --chairs.");
 			}
 		}else{
-			throw std::invalid_argument("Read a negative value from std::cin.");
+			throw std::invalid_argument("Read a negative value for --customers.");
 		}
 	}catch(const std::invalid_argument& ex){
-		std::cout << "Please input a single natural number, and nothing else.\n";
+		std::cout << ex.what() << "\nUsage: fifo_barbershop [--customers n] [--chairs n] [--workers n] [--coroutines 0|1] [--queue 0|1] [--seed s] [--repeat n]\n";
+		return 1;
 	}
+	write_latency_report();
 	return 0;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <mutex>
+#include <memory>
 #include <queue>
 #include <thread>
 #include <chrono>
@@ -8,11 +9,16 @@
 #include <functional>
 #include <condition_variable>
 #include "cpp/shared/parse.hpp"
+#include "cpp/shared/latency.hpp"
+#include "cpp/shared/coroutine.hpp"
+#include "cpp/shared/event_log.hpp"
 #include "cpp/shared/semaphore.hpp"
+#include "cpp/shared/thread_pool.hpp"
 
 typedef std::chrono::steady_clock testing_clock;
 
-std::mutex output_mutex;
+latency_histogram passenger_wait("passenger_wait");	//How long each passenger queues before a car lets them on.
+latency_histogram scenario_time("scenario");
 
 class park;
 class cart;
@@ -108,31 +114,25 @@ private:
 bool cart::load(){
 	std::unique_lock lk(lock);
 	
-	is_full.wait(lk, [=](){return passengers == capacity || terminated;});
+	is_full.wait(lk, [this](){return passengers == capacity || terminated;});
 	return !terminated;
 }
 
 void cart::run(){
-	output_mutex.lock();
-	std::cout << "(Car " << id << ") Now running...\n";
-	output_mutex.unlock();
+	log_event("(Car %d) Now running...\n", id);
 	
-	std::this_thread::sleep_for(std::chrono::milliseconds(std::rand() % 10));	
+	blocking_sleep_for(std::chrono::milliseconds(std::rand() % 10));	
 	unload_ready.wait();
 	
-	output_mutex.lock();
-	std::cout << "(Car " << id << ") Finished.\n";
-	output_mutex.unlock();
+	log_event("(Car %d) Finished.\n", id);
 }
 
 void cart::unload(){
 	std::unique_lock lk(lock);
 	
-	for(int i = 0; i < passengers; ++i){
-		passenger_holder.signal();
-	}
+	passenger_holder.signal(passengers);
 	
-	is_empty.wait(lk, [=](){return passengers == 0;});
+	is_empty.wait(lk, [this](){return passengers == 0;});
 }
 
 bool cart::board(int pass_id){
@@ -142,9 +142,7 @@ bool cart::board(int pass_id){
 		if(++passengers == capacity){
 			is_full.notify_one();
 		}
-		output_mutex.lock();
-		std::cout << "(Passenger " << pass_id << ") Boards car " << id << ".\n";
-		output_mutex.unlock();
+		log_event("(Passenger %d) Boards car %d.\n", pass_id, id);
 		return true;
 	}
 	return false;
@@ -160,9 +158,7 @@ void cart::unboard(int pass_id){
 	if(--passengers == 0){
 		is_empty.notify_one();
 	}
-	output_mutex.lock();
-	std::cout << "(Passenger " << pass_id << ") Disembarks from car " << id << ".\n";
-	output_mutex.unlock();
+	log_event("(Passenger %d) Disembarks from car %d.\n", pass_id, id);
 }
 
 void cart::terminate(){
@@ -179,9 +175,7 @@ void cart::terminate(){
 park::park(cart* cars, int n) : lock(), has_car_ready(0), waiting_cars(), running_cars(), loading_car(NULL), unloading_car(NULL) {
 	if(n > 0){
 		loading_car = cars;
-		for(int i = 0; i < cars[0].get_capacity(); ++i){
-			has_car_ready.signal();
-		}
+		has_car_ready.signal(cars[0].get_capacity());
 		for(int i = 1; i < n; ++i){
 			waiting_cars.push(cars + i);
 		}
@@ -202,9 +196,7 @@ void park::start_car(){
 		if(!waiting_cars.empty()){
 			loading_car = waiting_cars.front();
 			waiting_cars.pop();
-			for(int i = 0; i < loading_car->get_capacity(); ++i){
-				has_car_ready.signal();
-			}
+			has_car_ready.signal(loading_car->get_capacity());
 		}else{
 			loading_car = NULL;
 		}
@@ -217,9 +209,7 @@ void park::return_car(){
 	if(unloading_car != NULL){
 		if(loading_car == NULL){
 			loading_car = unloading_car;
-			for(int i = 0; i < loading_car->get_capacity(); ++i){
-				has_car_ready.signal();
-			}
+			has_car_ready.signal(loading_car->get_capacity());
 		}else{
 			waiting_cars.push(unloading_car);
 		}
@@ -255,74 +245,372 @@ void car(cart& me, park& the_park){
 }
 
 void passenger(int id, park& the_park){
+	testing_clock::time_point start = testing_clock::now();
 	cart* ride = the_park.queue_for_car();
+	passenger_wait.record_since(start);
 	ride->board(id);
 	ride->ride();
 	ride->unboard(id);
 }
 
-void test_scenario(int total_passengers, int total_cars, int total_seats){
+void test_scenario(int total_passengers, int total_cars, int total_seats, int workers){
 	cart* the_cars = reinterpret_cast<cart*>(new char[total_cars * sizeof(cart)]);	//Allocates space without initializing.
 	for(int i = 0; i < total_cars; ++i){
 		new (the_cars + i) cart(i, total_seats);	//Initializes into a specific memory location.
 	}
 	park the_park(the_cars, total_cars);
 	
-	//testing_clock::time_point start = testing_clock::now();
+	testing_clock::time_point start = testing_clock::now();
 	
+	std::unique_ptr<thread_pool> pool(workers > 0 ? new thread_pool(workers) : NULL);
 	std::vector<std::thread> cars;
-	std::vector<std::thread> passengers;
+	actor_group passengers(pool.get());
 	for(int i = 0; i < total_cars; ++i){
 		cars.push_back(std::thread(car, std::ref(the_cars[i]), std::ref(the_park)));
 	}
 	for(int i = 0; i < total_passengers; ++i){
-		passengers.push_back(std::thread(passenger, i, std::ref(the_park)));
+		passengers.spawn(passenger, i, std::ref(the_park));
 	}
 	
-	for(auto i = passengers.begin(); i != passengers.end(); ++i){
+	passengers.join();
+	
+	scenario_time.record_since(start);
+	
+	for(int i = 0; i < total_cars; ++i){
+		the_cars[i].terminate();
+	}
+	for(auto i = cars.begin(); i != cars.end(); ++i){
 		if(i->joinable()){
 			i->join();
 		}
 	}
 	
-	//std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(testing_clock::now() - start).count() << "\n";
+	delete [] reinterpret_cast<char*>(the_cars);
+}
+
+
+//----------Coroutine Classes----------
+
+class co_cart;
+
+class co_park{
+public:
+	
+	//Constructors/Destructor.
+	co_park(co_cart* cars, int n);
+	co_park(const co_park&) = delete;
+	co_park(co_park&&) = delete;
+	~co_park() = default;
+	
+	//Assignment Operators.
+	co_park& operator=(const co_park&) = delete;
+	co_park& operator=(co_park&&) = delete;
+	
+	//Park Interaction Functions.
+	co_subtask<co_cart*> queue_for_car();
+
+private:
+	
+	//Car-Only Interaction Functions.
+	void start_car();
+	void return_car();
+	
+	friend co_task co_car(co_cart& me, co_park& the_park);
+	
+	mutable std::mutex lock;
+	mutable co_semaphore has_car_ready;
+	
+	std::queue<co_cart*> waiting_cars;
+	std::queue<co_cart*> running_cars;
+	co_cart* loading_car;
+	co_cart* unloading_car;
+
+};
+
+/*
+ * The coroutine version of cart.  Instead of condition variables, the last passenger to board signals is_full, and the last to leave signals is_empty.
+ */
+class co_cart{
+public:
+	
+	//Constructors/Destructor.
+	co_cart(int i, int c) : lock(), is_full(0), is_empty(0), passenger_holder(0), unload_ready(0), id(i), capacity(c), terminated(false), passengers(0) {}
+	co_cart(const co_cart&) = delete;
+	co_cart(co_cart&&) = delete;
+	~co_cart() = default;
+	
+	//Assignment Operators.
+	co_cart& operator=(const co_cart&) = delete;
+	co_cart& operator=(co_cart&&) = delete;
+	
+	//Simple Accessors.
+	int get_id() const {return id;}
+	int get_capacity() const {return capacity;}
+	
+	//Passenger-usable Functions.
+	bool board(int pass_id);
+	co_semaphore::awaiter ride() {return passenger_holder.wait();}	//Wait until released.
+	void unboard(int pass_id);
+	
+	//Other Functions.
+	void terminate();
+
+private:
+	
+	//Car-only Functions.
+	co_subtask<bool> load();
+	co_subtask<> run();
+	co_subtask<> unload();
+	
+	friend co_task co_car(co_cart& me, co_park& the_park);
+	friend co_park;
+	
+	mutable std::mutex lock;
+	mutable co_semaphore is_full;
+	mutable co_semaphore is_empty;
+	mutable co_semaphore passenger_holder;
+	mutable co_semaphore unload_ready;
+	
+	const int id;
+	const int capacity;
+	bool terminated;
+	int passengers;
+
+};
+
+
+
+//----------Coroutine Cart Functions----------
+
+co_subtask<bool> co_cart::load(){
+	if(capacity > 0){
+		co_await is_full.wait();
+	}
+	
+	std::unique_lock lk(lock);
+	co_return !terminated;
+}
+
+co_subtask<> co_cart::run(){
+	log_event("(Car %d) Now running...\n", id);
+	
+	co_await co_sleep_for(std::chrono::milliseconds(std::rand() % 10));
+	co_await unload_ready.wait();
+	
+	log_event("(Car %d) Finished.\n", id);
+}
+
+co_subtask<> co_cart::unload(){
+	std::unique_lock lk(lock);
+	int riding = passengers;
+	lk.unlock();
 	
+	if(riding > 0){
+		passenger_holder.signal(riding);
+		co_await is_empty.wait();
+	}
+}
+
+bool co_cart::board(int pass_id){
+	std::unique_lock lk(lock);
+	
+	if(passengers < capacity){
+		if(++passengers == capacity){
+			is_full.signal();
+		}
+		log_event("(Passenger %d) Boards car %d.\n", pass_id, id);
+		return true;
+	}
+	return false;
+}
+
+void co_cart::unboard(int pass_id){
+	std::unique_lock lk(lock);
+	
+	if(--passengers == 0){
+		is_empty.signal();
+	}
+	log_event("(Passenger %d) Disembarks from car %d.\n", pass_id, id);
+}
+
+void co_cart::terminate(){
+	std::unique_lock lk(lock);
+	
+	terminated = true;
+	is_full.signal();
+}
+
+
+
+//----------Coroutine Park Functions----------
+
+co_park::co_park(co_cart* cars, int n) : lock(), has_car_ready(0), waiting_cars(), running_cars(), loading_car(NULL), unloading_car(NULL) {
+	if(n > 0){
+		loading_car = cars;
+		has_car_ready.signal(cars[0].get_capacity());
+		for(int i = 1; i < n; ++i){
+			waiting_cars.push(cars + i);
+		}
+	}
+}
+
+void co_park::start_car(){
+	std::unique_lock lk(lock);
+	
+	if(loading_car != NULL){
+		if(unloading_car == NULL){
+			unloading_car = loading_car;
+			unloading_car->unload_ready.signal();
+		}else{
+			running_cars.push(loading_car);
+		}
+		
+		if(!waiting_cars.empty()){
+			loading_car = waiting_cars.front();
+			waiting_cars.pop();
+			has_car_ready.signal(loading_car->get_capacity());
+		}else{
+			loading_car = NULL;
+		}
+	}
+}
+
+void co_park::return_car(){
+	std::unique_lock lk(lock);
+	
+	if(unloading_car != NULL){
+		if(loading_car == NULL){
+			loading_car = unloading_car;
+			has_car_ready.signal(loading_car->get_capacity());
+		}else{
+			waiting_cars.push(unloading_car);
+		}
+		
+		if(!running_cars.empty()){
+			unloading_car = running_cars.front();
+			running_cars.pop();
+			unloading_car->unload_ready.signal();
+		}else{
+			unloading_car = NULL;
+		}
+	}
+}
+
+co_subtask<co_cart*> co_park::queue_for_car(){
+	co_await has_car_ready.wait();
+	
+	std::unique_lock lk(lock);
+	co_return loading_car;
+}
+
+
+
+//----------Coroutine Actor Functions----------
+
+co_task co_car(co_cart& me, co_park& the_park){
+	while(true){
+		bool loaded = co_await me.load();	//GCC 12 miscompiles a co_await on a subtask inside a loop condition, so keep it out of there.
+		if(!loaded){
+			break;
+		}
+		
+		the_park.start_car();
+		co_await me.run();
+		co_await me.unload();
+		the_park.return_car();
+	}
+}
+
+co_task co_passenger(int id, co_park& the_park, co_semaphore& done){
+	testing_clock::time_point start = testing_clock::now();
+	co_cart* ride = co_await the_park.queue_for_car();
+	passenger_wait.record_since(start);
+	ride->board(id);
+	co_await ride->ride();
+	ride->unboard(id);
+	done.signal();
+}
+
+co_task co_queue_line(int total_passengers, co_park& the_park, co_cart* the_cars, int total_cars, co_scheduler& scheduler){
+	co_semaphore done;
+	for(int i = 0; i < total_passengers; ++i){
+		scheduler.spawn(co_passenger(i, the_park, done));
+	}
+	
+	co_await done.wait(total_passengers);
 	for(int i = 0; i < total_cars; ++i){
 		the_cars[i].terminate();
 	}
-	for(auto i = cars.begin(); i != cars.end(); ++i){
-		if(i->joinable()){
-			i->join();
+}
+
+void co_test_scenario(int total_passengers, int total_cars, int total_seats, int workers){
+	co_cart* the_cars = reinterpret_cast<co_cart*>(new char[total_cars * sizeof(co_cart)]);	//Allocates space without initializing.
+	for(int i = 0; i < total_cars; ++i){
+		new (the_cars + i) co_cart(i, total_seats);	//Initializes into a specific memory location.
+	}
+	
+	{
+		co_park the_park(the_cars, total_cars);
+		co_scheduler scheduler(workers);
+		
+		testing_clock::time_point start = testing_clock::now();
+		
+		for(int i = 0; i < total_cars; ++i){
+			scheduler.spawn(co_car(the_cars[i], the_park));
 		}
+		scheduler.spawn(co_queue_line(total_passengers, the_park, the_cars, total_cars, scheduler));
+		scheduler.run();
+		
+		scenario_time.record_since(start);
 	}
 	
+	for(int i = 0; i < total_cars; ++i){
+		the_cars[i].~co_cart();
+	}
 	delete [] reinterpret_cast<char*>(the_cars);
 }
 
-int main(){
-	std::srand(std::time(0));
+int main(int argc, char* argv[]){
 	try{
-		std::cout << "Please input how many passenger threads to run: ";
-		int passengers = scan_int();
+		parse_args(argc, argv, {"passengers", "cars", "seats", "workers", "coroutines"});
+		std::srand(arg_or("seed", std::time(0)));
+		long long repeat = arg_or("repeat", 1);
+		int passengers = arg_int("passengers", "Please input how many passenger threads to run: ");
 		if(passengers >= 0){
-			std::cout << "Please input how many roller coaster car threads to run: ";
-			int cars = scan_int();
+			int cars = arg_int("cars", "Please input how many roller coaster car threads to run: ");
 			if(cars >= 0){
-				std::cout << "Please input how many seats there are in the roller coaster cars: ";
-				int seats = scan_int();
+				int seats = arg_int("seats", "Please input how many seats there are in the roller coaster cars: ");
 				if(0 <= seats && seats <= passengers){
-					test_scenario(passengers, cars, seats);
+					int workers = arg_int("workers", "Please input how many worker threads to run the actors on (0 for one thread per actor): ");
+					if(workers >= 0){
+						int coroutines = arg_int("coroutines", "Please input 1 to run the actors as coroutines, or 0 to run them as threads: ");
+						if(coroutines == 1){
+							for(long long run = 0; run < repeat; ++run){
+								co_test_scenario(passengers, cars, seats, workers);
+							}
+						}else if(coroutines == 0){
+							for(long long run = 0; run < repeat; ++run){
+								test_scenario(passengers, cars, seats, workers);
+							}
+						}else{
+							throw std::invalid_argument("Read a value other than zero or one for --coroutines.");
+						}
+					}else{
+						throw std::invalid_argument("Read a negative value for --workers.");
+					}
 				}else{
-					throw std::invalid_argument("Please input a positive integer less than or equal to the number of passengers, and nothing else.");
+					throw std::invalid_argument("Read a negative value for --seats, or more seats than passengers.");
 				}
 			}else{
-				throw std::invalid_argument("Please input a single natural number, and nothing else.");
+				throw std::invalid_argument("Read a negative value for --cars.");
 			}
 		}else{
-			throw std::invalid_argument("Please input a single natural number, and nothing else.");
+			throw std::invalid_argument("Read a negative value for --passengers.");
 		}
 	}catch(const std::invalid_argument& ex){
-		std::cout << ex.what();
+		std::cout << ex.what() << "\nUsage: roller_coaster [--passengers n] [--cars n] [--seats n] [--workers n] [--coroutines 0|1] [--seed s] [--repeat n], with no more seats than passengers\n";
+		return 1;
 	}
+	write_latency_report();
 	return 0;
 }
\ No newline at end of file
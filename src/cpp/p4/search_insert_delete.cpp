@@ -1,4 +1,4 @@
-#include <list>
+#include <memory>
 #include <thread>
 #include <chrono>
 #include <vector>
@@ -6,208 +6,171 @@
 #include <iostream>
 #include <stdexcept>
 #include <functional>
-#include <shared_mutex>
 #include "cpp/shared/parse.hpp"
+#include "cpp/shared/lf_list.hpp"
+#include "cpp/shared/latency.hpp"
+#include "cpp/shared/container.hpp"
+#include "cpp/shared/fine_list.hpp"
+#include "cpp/shared/shard_set.hpp"
+#include "cpp/shared/skip_list.hpp"
+#include "cpp/shared/event_log.hpp"
+#include "cpp/shared/thread_pool.hpp"
 
 typedef std::chrono::steady_clock testing_clock;
 
-std::mutex output_mutex;
+latency_histogram search_time("search");		//How long each operation takes, waiting for locks included.
+latency_histogram insert_time("insert");
+latency_histogram delete_time("delete");
 
-struct container{
-	
-	//Constructors/Destructor.
-	container() : delete_lock(), insert_lock(), size_lock(), ctnr() {}
-	container(const container&) = delete;
-	container(container&&) = delete;
-	~container() = default;
-	
-	//Assignment Operators.
-	container& operator=(const container&) = delete;
-	container& operator=(container&&) = delete;
-	
-	//Container Functions.
-	std::list<int>::iterator find(int x);
-	
-	//Synchronization Members.
-	std::shared_mutex delete_lock;
-	std::mutex insert_lock;
-	std::mutex size_lock;
-	
-	//Mutable Members.
-	std::list<int> ctnr;
-
-};
-
-std::list<int>::iterator container::find(int x){
-	size_lock.lock();
-	int size = ctnr.size();
-	size_lock.unlock();
-	
-	auto item = ctnr.begin();
-	for(int i = 0; i < size; ++i){
-		if(*item == x){
-			return item;
-		}
-		++item;
-	}
-	throw std::range_error("The element is not in the list.");
-}
-
-void searcher(int id, container& c){
-	std::this_thread::sleep_for(std::chrono::milliseconds(1));
-	//testing_clock::time_point start = testing_clock::now();
-	
-	std::shared_lock<std::shared_mutex> del_lk(c.delete_lock);
-	
-	try{
-		c.find(id);
-		
-		output_mutex.lock();
-		std::cout << "(Searcher " << id << ") Found element {" << id << "}.\n";
-		output_mutex.unlock();
-	}catch(const std::range_error& ex){
-		output_mutex.lock();
-		std::cout << "(Searcher " << id << ") Did not find element {" << id << "}!\n";
-		output_mutex.unlock();
+template <class Container>
+void searcher(int id, Container& c){
+	blocking_sleep_for(std::chrono::milliseconds(1));
+	testing_clock::time_point start = testing_clock::now();
+	
+	if(c.contains(id)){
+		log_event("(Searcher %d) Found element {%d}.\n", id, id);
+	}else{
+		log_event("(Searcher %d) Did not find element {%d}!\n", id, id);
 	}
 	
-	/*output_mutex.lock();
-	std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(testing_clock::now() - start).count() << "\n";
-	output_mutex.unlock();*/
+	search_time.record_since(start);
 }
 
-void inserter(int id, container& c){
-	std::this_thread::sleep_for(std::chrono::milliseconds(1));
-	//testing_clock::time_point start = testing_clock::now();
+template <class Container>
+void inserter(int id, Container& c){
+	blocking_sleep_for(std::chrono::milliseconds(1));
+	testing_clock::time_point start = testing_clock::now();
 	
-	std::shared_lock<std::shared_mutex> del_lk(c.delete_lock);
-	std::unique_lock ins_lk(c.insert_lock);
+	bool added = c.insert(id);
 	
-	c.size_lock.lock();
-	c.ctnr.push_back(id);
-	c.size_lock.unlock();
+	insert_time.record_since(start);
 	
-	/*output_mutex.lock();
-	std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(testing_clock::now() - start).count() << "\n";
-	output_mutex.unlock();*/
-	
-	output_mutex.lock();
-	std::cout << "(Inserter " << id << ") Added element {" << id << "}.\n";
-	output_mutex.unlock();
+	if(added){
+		log_event("(Inserter %d) Added element {%d}.\n", id, id);
+	}else{
+		log_event("(Inserter %d) Element {%d} was already there!\n", id, id);
+	}
 }
 
-void deleter(int id, container& c){
-	std::this_thread::sleep_for(std::chrono::milliseconds(1));
-	//testing_clock::time_point start = testing_clock::now();
+template <class Container>
+void deleter(int id, Container& c){
+	blocking_sleep_for(std::chrono::milliseconds(1));
+	testing_clock::time_point start = testing_clock::now();
 	
-	std::unique_lock<std::shared_mutex> del_lk(c.delete_lock);
+	bool removed = c.remove(id);
 	
-	try{
-		std::list<int>::iterator elem = c.find(id);
-		c.ctnr.erase(elem);
-		
-		output_mutex.lock();
-		std::cout << "(Deleter " << id << ") Removed element {" << id << "}.\n";
-		output_mutex.unlock();
-	}catch(const std::range_error& ex){
-		output_mutex.lock();
-		std::cout << "(Deleter " << id << ") Did not find element {" << id << "}!\n";
-		output_mutex.unlock();
-	}
+	delete_time.record_since(start);
 	
-	/*output_mutex.lock();
-	std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(testing_clock::now() - start).count() << "\n";
-	output_mutex.unlock();*/
+	if(removed){
+		log_event("(Deleter %d) Removed element {%d}.\n", id, id);
+	}else{
+		log_event("(Deleter %d) Did not find element {%d}!\n", id, id);
+	}
 }
 
-void test_scenario(int total_searchers, int total_inserters, int total_deleters){
-	container the_container;
+template <class Container = container>		//container, or any of the set backends (lf_list<int>, shard_set<int>, ...).
+void test_scenario(int total_searchers, int total_inserters, int total_deleters, int workers){
+	Container the_container;
 	
-	std::vector<std::thread> searchers;
-	std::vector<std::thread> inserters;
-	std::vector<std::thread> deleters;
+	std::unique_ptr<thread_pool> pool(workers > 0 ? new thread_pool(workers) : NULL);
+	actor_group searchers(pool.get());
+	actor_group inserters(pool.get());
+	actor_group deleters(pool.get());
 	
 	for(int i = 0, j = 0, k = 0; i + j + k < total_searchers + total_inserters + total_deleters; ){
 		//std::this_thread::sleep_for(std::chrono::milliseconds(std::rand() % 5));
 		std::this_thread::sleep_for(std::chrono::milliseconds(1));
 		if(i < total_searchers && j < total_inserters && k < total_deleters){
 			if(std::rand() % 3 == 0){
-				searchers.push_back(std::thread(searcher, i++, std::ref(the_container)));
+				searchers.spawn(searcher<Container>, i++, std::ref(the_container));
 			}else{
 				if(std::rand() % 2 == 0){
-					inserters.push_back(std::thread(inserter, j++, std::ref(the_container)));
+					inserters.spawn(inserter<Container>, j++, std::ref(the_container));
 				}else{
-					deleters.push_back(std::thread(deleter, k++, std::ref(the_container)));
+					deleters.spawn(deleter<Container>, k++, std::ref(the_container));
 				}
 			}
 		}else if(i < total_searchers && j < total_inserters){
 			if(std::rand() % 2 == 0){
-				searchers.push_back(std::thread(searcher, i++, std::ref(the_container)));
+				searchers.spawn(searcher<Container>, i++, std::ref(the_container));
 			}else{
-				inserters.push_back(std::thread(inserter, j++, std::ref(the_container)));
+				inserters.spawn(inserter<Container>, j++, std::ref(the_container));
 			}
 		}else if(i < total_searchers && k < total_deleters){
 			if(std::rand() % 2 == 0){
-				searchers.push_back(std::thread(searcher, i++, std::ref(the_container)));
+				searchers.spawn(searcher<Container>, i++, std::ref(the_container));
 			}else{
-				deleters.push_back(std::thread(deleter, k++, std::ref(the_container)));
+				deleters.spawn(deleter<Container>, k++, std::ref(the_container));
 			}
 		}else if(j < total_inserters && k < total_deleters){
 			if(std::rand() % 2 == 0){
-				inserters.push_back(std::thread(inserter, j++, std::ref(the_container)));
+				inserters.spawn(inserter<Container>, j++, std::ref(the_container));
 			}else{
-				deleters.push_back(std::thread(deleter, k++, std::ref(the_container)));
+				deleters.spawn(deleter<Container>, k++, std::ref(the_container));
 			}
 		}else if(i < total_searchers){
-			searchers.push_back(std::thread(searcher, i++, std::ref(the_container)));
+			searchers.spawn(searcher<Container>, i++, std::ref(the_container));
 		}else if(j < total_inserters){
-			inserters.push_back(std::thread(inserter, j++, std::ref(the_container)));
+			inserters.spawn(inserter<Container>, j++, std::ref(the_container));
 		}else if(k < total_deleters){
-			deleters.push_back(std::thread(deleter, k++, std::ref(the_container)));
+			deleters.spawn(deleter<Container>, k++, std::ref(the_container));
 		}
 	}
 	
-	for(auto i = searchers.begin(); i != searchers.end(); ++i){
-		if(i->joinable()){
-			i->join();
-		}
-	}
-	for(auto i = inserters.begin(); i != inserters.end(); ++i){
-		if(i->joinable()){
-			i->join();
-		}
-	}
-	for(auto i = deleters.begin(); i != deleters.end(); ++i){
-		if(i->joinable()){
-			i->join();
-		}
-	}
+	searchers.join();
+	inserters.join();
+	deleters.join();
 }
 
-int main(){
-	std::srand(std::time(0));
+int main(int argc, char* argv[]){
 	try{
-		std::cout << "Please input how many searcher threads to run: ";
-		int searchers = scan_int();
+		parse_args(argc, argv, {"searchers", "inserters", "deleters", "workers", "backend"});
+		std::srand(arg_or("seed", std::time(0)));
+		long long repeat = arg_or("repeat", 1);
+		int searchers = arg_int("searchers", "Please input how many searcher threads to run: ");
 		if(searchers >= 0){
-			std::cout << "Please input how many inserter threads to run: ";
-			int inserters = scan_int();
+			int inserters = arg_int("inserters", "Please input how many inserter threads to run: ");
 			if(inserters >= 0){
-				std::cout << "Please input how many deleter threads to run: ";
-				int deleters = scan_int();
+				int deleters = arg_int("deleters", "Please input how many deleter threads to run: ");
 				if(deleters >= 0){
-					test_scenario(searchers, inserters, deleters);
+					int workers = arg_int("workers", "Please input how many worker threads to run the actors on (0 for one thread per actor): ");
+					if(workers >= 0){
+						int backend = arg_int("backend", "Please input which container to use (0 for the coarse-locked list, 1 for the lock-free list, 2 for the sharded hash set, 3 for the skip list, 4 for the hand-over-hand list, 5 for the lazy list): ");
+						if(0 <= backend && backend <= 5){
+							for(long long run = 0; run < repeat; ++run){
+								if(backend == 0){
+									test_scenario<container>(searchers, inserters, deleters, workers);
+								}else if(backend == 1){
+									test_scenario<lf_list<int>>(searchers, inserters, deleters, workers);
+								}else if(backend == 2){
+									test_scenario<shard_set<int>>(searchers, inserters, deleters, workers);
+								}else if(backend == 3){
+									test_scenario<skip_list<int>>(searchers, inserters, deleters, workers);
+								}else if(backend == 4){
+									test_scenario<coupled_list<int>>(searchers, inserters, deleters, workers);
+								}else{
+									test_scenario<lazy_list<int>>(searchers, inserters, deleters, workers);
+								}
+							}
+						}else{
+							throw std::invalid_argument("Read an unknown container for --backend.");
+						}
+					}else{
+						throw std::invalid_argument("Read a value less than zero for --workers.");
+					}
 				}else{
-					throw std::invalid_argument("Read a value less than zero from std::cin.");
+					throw std::invalid_argument("Read a value less than zero for --deleters.");
 				}
 			}else{
-				throw std::invalid_argument("Read a value less than zero from std::cin.");
+				throw std::invalid_argument("Read a value less than zero for --inserters.");
 			}
 		}else{
-			throw std::invalid_argument("Read a value less than zero from std::cin.");
+			throw std::invalid_argument("Read a value less than zero for --searchers.");
 		}
 	}catch(const std::invalid_argument& ex){
-		std::cout << "Please input a single integer larger than or equal to two, and nothing else.";
+		std::cout << ex.what() << "\nUsage: search_insert_delete [--searchers n] [--inserters n] [--deleters n] [--workers n] [--backend 0-5] [--seed s] [--repeat n]\n";
+		return 1;
 	}
+	write_latency_report();
 	return 0;
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include <mutex>
+#include <atomic>
+#include <memory>
 #include <thread>
 #include <chrono>
 #include <vector>
@@ -7,17 +9,22 @@
 #include <stdexcept>
 #include <functional>
 #include "cpp/shared/parse.hpp"
+#include "cpp/shared/latency.hpp"
+#include "cpp/shared/event_log.hpp"
 #include "cpp/shared/semaphore.hpp"
+#include "cpp/shared/thread_pool.hpp"
 
 typedef std::chrono::steady_clock testing_clock;
 
-std::mutex output_mutex;
+latency_histogram immigrant_wait("immigrant_wait");		//How long each arrival waits for the door while the judge is in.
+latency_histogram spectator_wait("spectator_wait");
+latency_histogram confirm_time("confirmation");			//How long the judge takes to confirm each batch.
 
 class hall{
 public:
 	
 	//Constructors/Destructor.
-	hall() : try_enter(), checked_in(0), swear_oath(0), certification(0), try_leave(), notify_leave(0), entered(0) {}
+	hall() : try_enter(), checked_in(0), swear_oath(0), certification(0), try_leave(), notify_leave(0), entered(0), open(true) {}
 	hall(const hall&) = delete;
 	hall(hall&&) = delete;
 	~hall() = default;
@@ -36,6 +43,8 @@ public:
 	void enter_judge(int prev_immigrants);
 	void confirm();
 	int leave_judge();
+	bool is_open() const {return open.load();}
+	void close() {open.store(false);}		//The judge goes home after their next visit.
 	
 	//Spectator Functions.
 	void enter_spectator(int id);
@@ -44,6 +53,8 @@ public:
 
 private:
 	
+	static void lock_door(std::unique_lock<std::mutex>& lk);		//The judge holds the doors for a whole confirmation, so waiting on one counts as blocking.
+	
 	//Synchronization Members.
 	std::mutex try_enter;
 	semaphore checked_in;
@@ -54,32 +65,38 @@ private:
 	
 	//Mutable Members.
 	int entered;
+	std::atomic<bool> open;
 
 };
 
 
 
+//----------Hall Functions----------
+
+void hall::lock_door(std::unique_lock<std::mutex>& lk){
+	if(!lk.try_lock()){
+		blocking_scope scope;
+		lk.lock();
+	}
+}
+
+
+
 //----------Immigrant Functions----------
 
 void hall::enter_immigrant(int id){
-	//testing_clock::time_point start = testing_clock::now();
-	std::unique_lock lk(try_enter);
-	
-	/*output_mutex.lock();
-	std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(testing_clock::now() - start).count() << "\n";
-	output_mutex.unlock();*/
+	testing_clock::time_point start = testing_clock::now();
+	std::unique_lock lk(try_enter, std::defer_lock);
+	lock_door(lk);
+	immigrant_wait.record_since(start);
 	
 	++entered;
 	
-	output_mutex.lock();
-	std::cout << "(Immigrant " << id << ") Arrives.\n";
-	output_mutex.unlock();
+	log_event("(Immigrant %d) Arrives.\n", id);
 }
 
 void hall::check_in(int id){
-	output_mutex.lock();
-	std::cout << "(Immigrant " << id << ") Checks in.\n";
-	output_mutex.unlock();
+	log_event("(Immigrant %d) Checks in.\n", id);
 	
 	checked_in.signal();
 }
@@ -87,19 +104,16 @@ void hall::check_in(int id){
 void hall::swear(int id){
 	swear_oath.wait();
 	
-	output_mutex.lock();
-	std::cout << "(Immigrant " << id << ") Swears their oath, and gets their certificate.\n";
-	output_mutex.unlock();
+	log_event("(Immigrant %d) Swears their oath, and gets their certificate.\n", id);
 	
 	certification.signal();
 }
 
 void hall::leave_immigrant(int id){
-	std::unique_lock lk(try_leave);
+	std::unique_lock lk(try_leave, std::defer_lock);
+	lock_door(lk);
 	
-	output_mutex.lock();
-	std::cout << "(Immigrant " << id << ") Leaves.\n";
-	output_mutex.unlock();
+	log_event("(Immigrant %d) Leaves.\n", id);
 	
 	notify_leave.signal();
 }
@@ -109,41 +123,29 @@ void hall::leave_immigrant(int id){
 //----------Judge Functions----------
 
 void hall::enter_judge(int prev_immigrants){
-	for(int i = 0; i < prev_immigrants; ++i){
-		notify_leave.wait();
-	}
+	notify_leave.wait(prev_immigrants);
 	
 	try_enter.lock();
 	try_leave.lock();
 	
-	output_mutex.lock();
-	std::cout << "(The Judge) Arrives.\n";
-	output_mutex.unlock();
+	log_event("(The Judge) Arrives.\n");
 }
 
 void hall::confirm(){
-	for(int i = 0; i < entered; ++i){
-		checked_in.wait();
-	}
+	checked_in.wait(entered);
 	
-	output_mutex.lock();
-	std::cout << "(The Judge) Begins the confirmation process.\n";
-	output_mutex.unlock();
+	log_event("(The Judge) Begins the confirmation process.\n");
 	
-	//testing_clock::time_point start = testing_clock::now();
+	testing_clock::time_point start = testing_clock::now();
 	for(int i = 0; i < entered; ++i){
 		swear_oath.signal();
 		certification.wait();
 	}
-	/*output_mutex.lock();
-	std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(testing_clock::now() - start).count() << "\n";
-	output_mutex.unlock();*/
+	confirm_time.record_since(start);
 }
 
 int hall::leave_judge(){
-	output_mutex.lock();
-	std::cout << "(The Judge) Leaves.\n";
-	output_mutex.unlock();
+	log_event("(The Judge) Leaves.\n");
 	
 	int prev_immigrants = entered;
 	entered = 0;
@@ -158,30 +160,22 @@ int hall::leave_judge(){
 //----------Spectator Functions----------
 
 void hall::enter_spectator(int id){
-	//testing_clock::time_point start = testing_clock::now();
-	std::unique_lock lk(try_enter);
+	testing_clock::time_point start = testing_clock::now();
+	std::unique_lock lk(try_enter, std::defer_lock);
+	lock_door(lk);
+	spectator_wait.record_since(start);
 	
-	/*output_mutex.lock();
-	std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(testing_clock::now() - start).count() << "\n";
-	output_mutex.unlock();*/
-	
-	output_mutex.lock();
-	std::cout << "(Spectator " << id << ") Arrives.\n";
-	output_mutex.unlock();
+	log_event("(Spectator %d) Arrives.\n", id);
 }
 
 void hall::spectate(int id){
-	output_mutex.lock();
-	std::cout << "(Spectator " << id << ") Spectates.\n";
-	output_mutex.unlock();
+	log_event("(Spectator %d) Spectates.\n", id);
 	
-	std::this_thread::sleep_for(std::chrono::milliseconds(std::rand() % 100));
+	blocking_sleep_for(std::chrono::milliseconds(std::rand() % 100));
 }
 
 void hall::leave_spectator(int id){
-	output_mutex.lock();
-	std::cout << "(Spectator " << id << ") Leaves.\n";
-	output_mutex.unlock();
+	log_event("(Spectator %d) Leaves.\n", id);
 }
 
 
@@ -189,9 +183,9 @@ void hall::leave_spectator(int id){
 //----------Thread Functions----------
 
 void immigrant(int id, hall& fh){
-	std::this_thread::sleep_for(std::chrono::milliseconds(std::rand() % 2000));	//In transit.
+	blocking_sleep_for(std::chrono::milliseconds(std::rand() % 2000));	//In transit.
 	fh.enter_immigrant(id);
-	std::this_thread::sleep_for(std::chrono::milliseconds(std::rand() % 200));	//Find way to check-in.
+	blocking_sleep_for(std::chrono::milliseconds(std::rand() % 200));	//Find way to check-in.
 	fh.check_in(id);
 	fh.swear(id);
 	fh.leave_immigrant(id);
@@ -199,7 +193,7 @@ void immigrant(int id, hall& fh){
 
 void judge(hall& fh){
 	int prev_immigrants = 0;
-	while(true){
+	while(fh.is_open()){
 		std::this_thread::sleep_for(std::chrono::milliseconds(std::rand() % 10));	//In transit.
 		fh.enter_judge(prev_immigrants);
 		fh.confirm();
@@ -208,66 +202,70 @@ void judge(hall& fh){
 }
 
 void spectator(int id, hall& fh){
-	std::this_thread::sleep_for(std::chrono::milliseconds(std::rand() % 2000));	//In transit.
+	blocking_sleep_for(std::chrono::milliseconds(std::rand() % 2000));	//In transit.
 	fh.enter_spectator(id);
 	fh.spectate(id);
 	fh.leave_spectator(id);
 }
 
-void test_scenario(int total_immigrants, int total_spectators){
+void test_scenario(int total_immigrants, int total_spectators, int workers){
 	hall fh;
 	
 	std::thread the_judge(judge, std::ref(fh));
-	the_judge.detach();
 	
-	std::vector<std::thread> immigrants;
-	std::vector<std::thread> spectators;
+	std::unique_ptr<thread_pool> pool(workers > 0 ? new thread_pool(workers) : NULL);
+	actor_group immigrants(pool.get());
+	actor_group spectators(pool.get());
 	
 	for(int i = 0, j = 0; i + j < total_immigrants + total_spectators; ){
 		std::this_thread::sleep_for(std::chrono::milliseconds(std::rand() % 10));
 		if(i < total_immigrants && j < total_spectators){
 			if(std::rand() % 2 == 0){
-				immigrants.push_back(std::thread(immigrant, i++, std::ref(fh)));
+				immigrants.spawn(immigrant, i++, std::ref(fh));
 			}else{
-				spectators.push_back(std::thread(spectator, j++, std::ref(fh)));
+				spectators.spawn(spectator, j++, std::ref(fh));
 			}
 		}else if(i < total_immigrants){
-			immigrants.push_back(std::thread(immigrant, i++, std::ref(fh)));
+			immigrants.spawn(immigrant, i++, std::ref(fh));
 		}else if(j < total_spectators){
-			spectators.push_back(std::thread(spectator, j++, std::ref(fh)));
+			spectators.spawn(spectator, j++, std::ref(fh));
 		}
 	}
 	
-	for(auto i = immigrants.begin(); i != immigrants.end(); ++i){
-		if(i->joinable()){
-			i->join();
-		}
-	}
-	for(auto i = spectators.begin(); i != spectators.end(); ++i){
-		if(i->joinable()){
-			i->join();
-		}
-	}
+	immigrants.join();
+	spectators.join();
+	
+	fh.close();			//Every immigrant has left, so the judge can't get stuck waiting on one.
+	the_judge.join();	//The hall is about to go away, and the judge can't outlive it (e.g. with --repeat).
 }
 
-int main(){
-	std::srand(std::time(0));
+int main(int argc, char* argv[]){
 	try{
-		std::cout << "Please input how many immigrant threads to run: ";
-		int immigrants = scan_int();
+		parse_args(argc, argv, {"immigrants", "spectators", "workers"});
+		std::srand(arg_or("seed", std::time(0)));
+		long long repeat = arg_or("repeat", 1);
+		int immigrants = arg_int("immigrants", "Please input how many immigrant threads to run: ");
 		if(immigrants >= 0){
-			std::cout << "Please input how many spectator threads to run: ";
-			int spectators = scan_int();
+			int spectators = arg_int("spectators", "Please input how many spectator threads to run: ");
 			if(spectators >= 0){
-				test_scenario(immigrants, spectators);
+				int workers = arg_int("workers", "Please input how many worker threads to run the actors on (0 for one thread per actor): ");
+				if(workers >= 0){
+					for(long long run = 0; run < repeat; ++run){
+						test_scenario(immigrants, spectators, workers);
+					}
+				}else{
+					throw std::invalid_argument("Read a value less than zero for --workers.");
+				}
 			}else{
-				throw std::invalid_argument("Read a value less than zero from std::cin.");
+				throw std::invalid_argument("Read a value less than zero for --spectators.");
 			}
 		}else{
-			throw std::invalid_argument("Read a value less than zero from std::cin.");
+			throw std::invalid_argument("Read a value less than zero for --immigrants.");
 		}
 	}catch(const std::invalid_argument& ex){
-		std::cout << "Please input a single natural number, and nothing else.";
+		std::cout << ex.what() << "\nUsage: faneuil_hall [--immigrants n] [--spectators n] [--workers n] [--seed s] [--repeat n]\n";
+		return 1;
 	}
+	write_latency_report();
 	return 0;
 }
\ No newline at end of file
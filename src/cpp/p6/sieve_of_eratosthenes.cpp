@@ -1,113 +1,374 @@
-#include <list>
+#include <cmath>
+#include <memory>
+#include <string>
 #include <vector>
 #include <thread>
 #include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
 #include <iostream>
 #include <functional>
 #include "cpp/shared/parse.hpp"
-#include "cpp/shared/semaphore.hpp"
+#include "cpp/shared/latency.hpp"
+#include "cpp/shared/spsc_ring.hpp"
+#include "cpp/shared/bulk_writer.hpp"
+#include "cpp/shared/thread_pool.hpp"
+#include "cpp/shared/prime_range.hpp"
+#include "cpp/shared/prime_table.hpp"
+#include "cpp/shared/prime_count.hpp"
+#include "cpp/shared/segmented_sieve.hpp"
 
 typedef std::chrono::steady_clock testing_clock;
 
-struct shared_lists{
-	
-	std::list<std::list<int>> sieve_data;	//These lists are used specifically so that iterators are not invalidated after insertions.
-	std::list<semaphore> sieve_sems;
+latency_histogram sieve_time("sieve");	//How long finding the primes takes.  When they're streamed (see test_scenario) that includes printing them.
 
-};
+typedef spsc_ring<int> channel;
+
+constexpr std::size_t channel_capacity = 256;	//Per stage, and recycled, so a stage's memory doesn't grow with n (but see find_primes_up_to).
+constexpr std::size_t batch_size = 64;			//Values are handed on in batches, one publish and at most one wake-up each.
+constexpr std::size_t pipeline_capacity = 4096;	//The fixed-stage pipeline only has a handful of links, so they can be roomier.
 
-void generate(int n, std::list<std::list<int>>::iterator output, std::list<semaphore>::iterator output_notify){
+void generate(int n, std::shared_ptr<channel> output){
+	int batch[batch_size];
+	std::size_t count = 0;
 	for(int i = 2; i <= n; ++i){
-		output->push_back(i);
-		output_notify->signal();
+		batch[count++] = i;
+		if(count == batch_size){
+			output->push(batch, count);
+			count = 0;
+		}
 	}
-	output->push_back(0);
-	output_notify->signal();
+	output->push(batch, count);
+	output->close();
 }
 
-void sieve(std::list<std::list<int>>::iterator input, std::list<semaphore>::iterator input_notify, shared_lists& shared_data, std::vector<int>& primes){
-	input_notify->wait();
-	int prime = *(input->begin());
+//Whether none of the group's primes divide value.  The group has to hold every prime up to sqrt(value) that earlier stages don't.
+bool coprime_to(const std::vector<int>& group, int value){
+	for(auto p = group.begin(); p != group.end() && *p <= value / *p; ++p){
+		if(value % *p == 0){
+			return false;
+		}
+	}
+	return true;
+}
+
+void sieve(std::shared_ptr<channel> input, std::vector<int>& primes, actor_group& stages, int spare_stages){
+	int batch[batch_size];
+	std::size_t count = input->pop(batch, batch_size);
+	if(count == 0){
+		return;
+	}
+	int prime = batch[0];
 	
 	primes.push_back(prime);	//Doesn't need a mutex, no two threads will ever excute this at the same time.  The thread which created this one already added its prime before spinning off this thread.
 	
-	shared_data.sieve_data.push_back(std::list<int>());	//Likewise with this little block, and for exactly the same reasons.
-	shared_data.sieve_sems.emplace_back(0);
-	std::list<std::list<int>>::iterator output = --(shared_data.sieve_data.end());
-	std::list<semaphore>::iterator output_notify = --(shared_data.sieve_sems.end());
-	
-	std::thread next;
-	bool has_next = false;
-	std::list<int>::iterator value = input->begin();
-	input_notify->wait();
-	while(*(++value) != 0){
-		if(*value % prime != 0){
-			if(!has_next){
-				has_next = true;
-				next = std::thread(sieve, output, output_notify, std::ref(shared_data), std::ref(primes));
+	std::vector<int> group(1, prime);	//Once there's no room for another stage, this one keeps every prime after its own.
+	std::shared_ptr<channel> output;	//Only made once something gets through, so the last stage doesn't have one.
+	int passed[batch_size];
+	std::size_t passed_count = 0;
+	for(std::size_t i = 1; count != 0; i = 0, count = input->pop(batch, batch_size)){
+		for(; i < count; ++i){
+			if(spare_stages == 0){
+				if(coprime_to(group, batch[i])){
+					group.push_back(batch[i]);
+					primes.push_back(batch[i]);
+				}
+			}else if(batch[i] % prime != 0){
+				if(!output){
+					output = std::make_shared<channel>(channel_capacity);
+					stages.spawn(sieve, output, std::ref(primes), std::ref(stages), spare_stages - 1);
+				}
+				passed[passed_count++] = batch[i];
+				if(passed_count == batch_size){
+					output->push(passed, passed_count);
+					passed_count = 0;
+				}
 			}
-			output->push_back(*value);
-			output_notify->signal();
 		}
-		input_notify->wait();
 	}
 	
-	if(has_next){
-		output->push_back(0);
-		output_notify->signal();
-		if(next.joinable()){
-			next.join();
-		}
+	if(output){
+		output->push(passed, passed_count);
+		output->close();
 	}
 }
 
-std::vector<int> find_primes_up_to(int n){
-	shared_lists data;
+/*
+ * The classic pipeline, with a stage for every prime.  Each stage only ever holds one ring, but every prime up to n gets a stage
+ * (a thread or a pool task) and a ring of its own, so the whole pipeline still takes O(pi(n)) memory and threads.
+ * In a pool every stage can be blocked at once, waiting on the one after it, so there are only as many stages as the pool has threads,
+ * and the last one keeps the rest of the primes itself.
+ * find_primes_pipelined is the version with a fixed number of stages.
+ */
+std::vector<int> find_primes_up_to(int n, int workers){
 	std::vector<int> primes;
+	std::unique_ptr<thread_pool> pool(workers > 0 ? new thread_pool(workers) : NULL);
+	int spare_stages = pool ? pool->size() + thread_pool::default_max_extra - 2 : INT_MAX;		//Leaves a thread for the generator.
+	actor_group stages(pool.get());
 	
-	data.sieve_data.push_back(std::list<int>());
-	data.sieve_sems.emplace_back(0);
+	std::shared_ptr<channel> first = std::make_shared<channel>(channel_capacity);
+	stages.spawn(generate, n, first);
+	stages.spawn(sieve, first, std::ref(primes), std::ref(stages), spare_stages);
+	stages.join();		//Also waits for every stage spawned along the way.
 	
-	std::thread generator(generate, n, data.sieve_data.begin(), data.sieve_sems.begin());
-	std::thread first_sieve(sieve, data.sieve_data.begin(), data.sieve_sems.begin(), std::ref(data), std::ref(primes));
+	return primes;
+}
+
+/*
+ * One of a fixed number of pipeline stages.  Each stage filters by its own group of consecutive primes, adopting primes up to sqrt(n)
+ * as they arrive until the group is full (the last stage never fills up).  Values known to be prime are passed on negated,
+ * so later stages skip them, and everything comes out of the last stage in order.
+ */
+void filter_stage(std::shared_ptr<channel> input, std::shared_ptr<channel> output, std::size_t group_size, int root, std::vector<int>& primes){
+	std::vector<int> group;
+	int batch[batch_size];
+	int passed[batch_size];
+	std::size_t passed_count = 0;
 	
-	if(generator.joinable()){
-		generator.join();
+	for(std::size_t count = input->pop(batch, batch_size); count != 0; count = input->pop(batch, batch_size)){
+		for(std::size_t i = 0; i < count; ++i){
+			int value = batch[i];
+			if(value > 0){
+				bool composite = false;
+				bool prime = group.size() < group_size;		//No later stage has any primes yet, so passing this one is enough.
+				for(auto p = group.begin(); p != group.end(); ++p){
+					if(*p > value / *p){
+						prime = true;		//Every prime up to sqrt(value) lives in this stage or an earlier one.
+						break;
+					}
+					if(value % *p == 0){
+						composite = true;
+						break;
+					}
+				}
+				if(composite){
+					continue;
+				}
+				if(prime && (value > root || group.size() < group_size)){		//Small primes still need a stage to adopt them.
+					if(value <= root){
+						group.push_back(value);
+					}
+					value = -value;
+				}
+			}
+			
+			if(!output){
+				primes.push_back(value < 0 ? -value : value);	//Only the last stage gets here.
+				continue;
+			}
+			passed[passed_count++] = value;
+			if(passed_count == batch_size){
+				output->push(passed, passed_count);
+				passed_count = 0;
+			}
+		}
 	}
-	if(first_sieve.joinable()){
-		first_sieve.join();
+	
+	if(output){
+		output->push(passed, passed_count);
+		output->close();
+	}
+}
+
+std::vector<int> find_primes_pipelined(int n, int total_stages, int group_size){
+	if(total_stages < 1){
+		total_stages = std::max(1u, std::thread::hardware_concurrency());
+	}
+	int root = 1;
+	while(root + 1 <= n / (root + 1)){
+		++root;
+	}
+	
+	std::vector<int> primes;
+	std::vector<std::shared_ptr<channel>> links;
+	for(int i = 0; i < total_stages; ++i){
+		links.push_back(std::make_shared<channel>(pipeline_capacity));
 	}
 	
+	actor_group stages;
+	stages.spawn(generate, n, links[0]);
+	for(int i = 0; i < total_stages; ++i){
+		bool last = i + 1 == total_stages;
+		stages.spawn(filter_stage, links[i], last ? nullptr : links[i + 1], last ? SIZE_MAX : std::size_t(group_size), root, std::ref(primes));
+	}
+	stages.join();
+	
 	return primes;
 }
 
-void test_scenario(int n){
-	//testing_clock::time_point start = testing_clock::now();
-	std::vector<int> primes = find_primes_up_to(n);
-	//std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(testing_clock::now() - start).count() << "\n";
+std::vector<int> find_primes_parallel(int n, int threads){
+	return parallel_segmented_primes<int>(2, n, threads);
+}
+
+//The prime table file, from the PRIME_TABLE environment variable if it's set.
+std::string prime_table_path(){
+	const char* path = std::getenv("PRIME_TABLE");
+	return path != NULL && *path != '\0' ? path : "sieve_of_eratosthenes.primes";
+}
+
+//An upper bound on the k-th prime, so the table can be made big enough to find it (Rosser's bound, plus some slack for rounding).
+std::uint64_t nth_prime_bound(std::uint64_t k){
+	if(k < 6){
+		return 13;
+	}
+	double x = k;
+	return std::uint64_t(x * (std::log(x) + std::log(std::log(x)))) + 1024;
+}
+
+/*
+ * Prints primes straight to stdout through a bulk_writer, so printing keeps up with the sieve.
+ * Format 0 is ", "-separated decimal text ending in a newline, and 1 and 2 are raw little-endian uint32s or uint64s.
+ */
+class prime_printer{
+public:
 	
-	std::cout << "The prime numbers from two to " << n << "\n";
-	for(auto i = primes.begin(); i != primes.end(); ++i){
-		auto next = (++i)--;
-		if(next != primes.end()){
-			std::cout << *i << ", ";
+	explicit prime_printer(int f) : format(f), out(), first(true) {}
+	
+	void operator()(std::uint64_t p){
+		if(format == 1){
+			out.write_raw(std::uint32_t(p));
+		}else if(format == 2){
+			out.write_raw(p);
+		}else{
+			if(!first){
+				out.write_text(", ", 2);
+			}
+			out.write_decimal(p);
+		}
+		first = false;
+	}
+	
+	void finish(){
+		if(format == 0){
+			out.write_text("\n", 1);
+		}
+		out.flush();
+	}
+
+private:
+	
+	int format;
+	bulk_writer out;
+	bool first;
+
+};
+
+void test_scenario(long long n, int workers, int mode, int group_size, int format){
+	if(mode == 5){		//Just the count, without finding the primes themselves.
+		testing_clock::time_point start = testing_clock::now();
+		std::uint64_t count = prime_pi(n);
+		sieve_time.record_since(start);
+		std::cout << "There are " << count << " prime numbers from two to " << n << "\n";
+		return;
+	}
+	
+	if(mode >= 6){		//Questions for the prime table, which only sieves whatever it doesn't cover yet.  The answers are always text.
+		testing_clock::time_point start = testing_clock::now();
+		prime_table table(prime_table_path(), mode == 8 ? nth_prime_bound(n) : n);
+		if(mode == 6){
+			bool prime = table.is_prime(n);
+			sieve_time.record_since(start);
+			std::cout << n << (prime ? " is" : " is not") << " a prime number\n";
+		}else if(mode == 7){
+			std::uint64_t count = table.count_primes(n);		//One lookup in the rank index, and at most one block of popcounts.
+			sieve_time.record_since(start);
+			std::cout << "There are " << count << " prime numbers from two to " << n << "\n";
 		}else{
-			std::cout << *i << "\n";
+			std::uint64_t prime = table.nth_prime(n);
+			sieve_time.record_since(start);
+			std::cout << "Prime number " << n << " is " << prime << "\n";
 		}
+		return;
 	}
+	
+	if(format == 0){		//Raw output is nothing but the primes.
+		std::cout << "The prime numbers from two to " << n << "\n";
+		std::cout.flush();		//Everything after this goes around std::cout.
+	}
+	prime_printer print(format);
+	
+	if(mode == 4){		//Only sieves whatever the table doesn't cover yet.
+		testing_clock::time_point start = testing_clock::now();
+		prime_table table(prime_table_path(), n);
+		table.for_each_prime(2, n, [&](std::uint64_t p){print(p);});
+		print.finish();
+		sieve_time.record_since(start);
+		return;
+	}
+	
+	if(mode == 1 || n > INT_MAX){		//Print the primes straight out of the sieve as they're found, rather than holding on to them.
+		testing_clock::time_point start = testing_clock::now();
+		if(mode == 2){
+			parallel_for_each_prime(2, n, workers, [&](std::uint64_t p){print(p);});
+		}else{
+			for(std::uint64_t p : prime_range(2, n)){
+				print(p);
+			}
+		}
+		print.finish();
+		sieve_time.record_since(start);
+		return;
+	}
+	
+	testing_clock::time_point start = testing_clock::now();
+	std::vector<int> primes;
+	if(mode == 0){
+		primes = find_primes_up_to(n, workers);
+	}else if(mode == 2){
+		primes = find_primes_parallel(n, workers);
+	}else{
+		primes = find_primes_pipelined(n, workers, group_size);
+	}
+	sieve_time.record_since(start);
+	
+	for(auto i = primes.begin(); i != primes.end(); ++i){
+		print(*i);
+	}
+	print.finish();
 }
 
-int main(){
+int main(int argc, char* argv[]){
 	try{
-		std::cout << "Please input which number to print the primes up to: ";
-		int max = scan_int();
-		if(max >= 2){
-			test_scenario(max);
+		prompt_to(std::cerr);		//stdout may be raw binary, so it only ever gets the primes.
+		parse_args(argc, argv, {"n", "workers", "output", "sieve", "primes_per_stage"});
+		long long repeat = arg_or("repeat", 1);
+		long long max = arg_long("n", "Please input which number to print the primes up to (or to ask the prime table about): ");
+		if(max >= 1 && static_cast<unsigned long long>(max) <= segmented_sieve::max_value){
+			int workers = arg_int("workers", "Please input how many worker threads to run the sieve on (0 for one thread per pipeline stage, or one per core for the parallel sieve): ");
+			if(workers >= 0){
+				int format = arg_int("output", "Please input how to print the primes (0 for text, 1 for raw little-endian uint32s, 2 for raw little-endian uint64s): ");
+				if(format < 0 || format > 2 || (format == 1 && static_cast<unsigned long long>(max) > UINT32_MAX)){
+					throw std::invalid_argument("Read an unknown output format for --output, or uint32s for an --n past 2^32.");
+				}
+				int mode = arg_int("sieve", "Please input which sieve to run (0 for the pipeline, 1 for the segmented sieve, 2 for the parallel segmented sieve, 3 for a pipeline of that many stages, 4 for the on-disk prime table, 5 to only count them, 6 to ask the table whether it's prime, 7 to count them with the table, 8 to ask the table for the prime at that position): ");
+				int group_size = 0;
+				if(mode == 3){
+					group_size = arg_int("primes_per_stage", "Please input how many primes each pipeline stage should filter by: ");
+				}
+				bool in_table = static_cast<unsigned long long>(max) < segmented_sieve::max_value - prime_table::block_span;
+				bool nth_in_table = max < (1LL << 56) && nth_prime_bound(max) < segmented_sieve::max_value - prime_table::block_span;
+				if((max >= 2 && (mode == 1 || mode == 2 || mode == 5 || (mode == 4 && in_table) || ((mode == 0 || (mode == 3 && group_size > 0)) && max <= INT_MAX))) || ((mode == 6 || mode == 7) && in_table) || (mode == 8 && nth_in_table)){
+					for(long long run = 0; run < repeat; ++run){
+						test_scenario(max, workers, mode, group_size, format);
+					}
+				}else{
+					throw std::invalid_argument("Read an unknown sieve for --sieve, or an --n (or --primes_per_stage) out of range for it.");
+				}
+			}else{
+				throw std::invalid_argument("Read a value less than zero for --workers.");
+			}
 		}else{
-			throw std::invalid_argument("Read a value less than two from std::cin.");
+			throw std::invalid_argument("Read a value less than one, or larger than 2^62, for --n.");
 		}
 	}catch(const std::invalid_argument& ex){
-		std::cout << "Please input a single integer larger than or equal to two, and nothing else.";
+		std::cerr << ex.what() << "\nUsage: sieve_of_eratosthenes [--n n] [--workers n] [--output 0-2] [--sieve 0-8] [--primes_per_stage n] [--repeat n]\n";
+		return 1;
+	}catch(const std::runtime_error& ex){
+		std::cerr << ex.what() << "\n";		//The prime table file couldn't be written.
+		return 1;
 	}
+	write_latency_report();
 	return 0;
 }
\ No newline at end of file
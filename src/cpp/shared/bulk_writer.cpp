@@ -0,0 +1,84 @@
+#include <cerrno>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <unistd.h>
+#include "cpp/shared/bulk_writer.hpp"
+
+namespace{
+
+//"00" through "99", so each division by 100 gives two digits at once.
+const char digit_pairs[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+}
+
+
+
+//----------Constructor/Destructor----------
+
+bulk_writer::bulk_writer(int f) : fd(f), buffer(buffer_size), used(0) {}
+
+bulk_writer::~bulk_writer(){
+	try{
+		flush();
+	}catch(const std::runtime_error& ex){}
+}
+
+
+
+//----------Writing Functions----------
+
+void bulk_writer::write_text(const char* text, std::size_t length){
+	if(length > buffer_size){
+		flush();
+		for(std::size_t i = 0; i < length; i += buffer_size){
+			write_text(text + i, std::min(buffer_size, length - i));
+		}
+		return;
+	}
+	make_room(length);
+	std::memcpy(buffer.data() + used, text, length);
+	used += length;
+}
+
+void bulk_writer::write_decimal(std::uint64_t value){
+	char digits[20];		//Filled from the back.
+	char* start = digits + sizeof(digits);
+	while(value >= 100){
+		std::uint64_t pair = value % 100;
+		value /= 100;
+		start -= 2;
+		std::memcpy(start, digit_pairs + 2 * pair, 2);
+	}
+	if(value >= 10){
+		start -= 2;
+		std::memcpy(start, digit_pairs + 2 * value, 2);
+	}else{
+		*--start = '0' + value;
+	}
+	
+	std::size_t length = digits + sizeof(digits) - start;
+	make_room(length);
+	std::memcpy(buffer.data() + used, start, length);
+	used += length;
+}
+
+void bulk_writer::flush(){
+	std::size_t done = 0;
+	while(done < used){
+		ssize_t written = ::write(fd, buffer.data() + done, used - done);
+		if(written < 0){
+			if(errno == EINTR){
+				continue;
+			}
+			used = 0;
+			throw std::runtime_error(std::string("Couldn't write the output: ") + std::strerror(errno));
+		}
+		done += written;
+	}
+	used = 0;
+}
\ No newline at end of file
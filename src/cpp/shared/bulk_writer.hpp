@@ -0,0 +1,53 @@
+#ifndef BULK_WRITER_H_INCLUDED
+#define BULK_WRITER_H_INCLUDED
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/*
+ * A buffered writer straight onto a file descriptor, for printing millions of numbers without going through iostreams.
+ * Integers are converted to decimal by hand, two digits at a time, into a large buffer which goes out with write(2) whenever it fills.
+ * Nothing else may write to the same descriptor in between (flush std::cout before making one on stdout).
+ */
+class bulk_writer{
+public:
+	
+	static constexpr std::size_t buffer_size = 1 << 20;
+	
+	//Constructors/Destructor.
+	explicit bulk_writer(int fd = 1);
+	bulk_writer(const bulk_writer&) = delete;
+	bulk_writer(bulk_writer&&) = delete;
+	~bulk_writer();		//Flushes, but can't report errors, so call flush() first to find out about them.
+	
+	//Assignment Operators.
+	bulk_writer& operator=(const bulk_writer&) = delete;
+	bulk_writer& operator=(bulk_writer&&) = delete;
+	
+	//Writing Operations.
+	void write_text(const char* text, std::size_t length);
+	void write_decimal(std::uint64_t value);
+	template <class T>
+	void write_raw(T value);		//The value's bytes, little-endian whatever the host is.
+	void flush();					//Throws std::runtime_error if the write fails.
+
+private:
+	
+	void make_room(std::size_t length) {if(buffer_size - used < length){flush();}}		//Only for lengths up to buffer_size.
+	
+	int fd;
+	std::vector<char> buffer;
+	std::size_t used;
+
+};
+
+template <class T>
+void bulk_writer::write_raw(T value){
+	make_room(sizeof(T));
+	for(std::size_t i = 0; i < sizeof(T); ++i){
+		buffer[used++] = static_cast<char>(value >> (8 * i));
+	}
+}
+
+#endif
\ No newline at end of file
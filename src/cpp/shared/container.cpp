@@ -0,0 +1,50 @@
+#include <stdexcept>
+#include "cpp/shared/container.hpp"
+
+std::list<int>::iterator container::find(int x){
+	size_lock.lock();
+	int size = ctnr.size();
+	size_lock.unlock();
+	
+	auto item = ctnr.begin();
+	for(int i = 0; i < size; ++i){
+		if(*item == x){
+			return item;
+		}
+		++item;
+	}
+	throw std::range_error("The element is not in the list.");
+}
+
+bool container::contains(int x){
+	std::shared_lock<std::shared_mutex> del_lk(delete_lock);
+	
+	try{
+		find(x);
+		return true;
+	}catch(const std::range_error& ex){
+		return false;
+	}
+}
+
+bool container::insert(int x){
+	std::shared_lock<std::shared_mutex> del_lk(delete_lock);
+	std::unique_lock ins_lk(insert_lock);
+	
+	size_lock.lock();
+	ctnr.push_back(x);
+	size_lock.unlock();
+	return true;
+}
+
+bool container::remove(int x){
+	std::unique_lock<std::shared_mutex> del_lk(delete_lock);
+	
+	try{
+		std::list<int>::iterator elem = find(x);
+		ctnr.erase(elem);
+		return true;
+	}catch(const std::range_error& ex){
+		return false;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef CONTAINER_H_INCLUDED
+#define CONTAINER_H_INCLUDED
+
+#include <list>
+#include <mutex>
+#include <shared_mutex>
+
+/*
+ * The original container: a std::list behind three coarse locks, and the baseline the other set backends get measured against.
+ * Searchers and inserters share delete_lock, inserters take turns on insert_lock, and a deleter holds delete_lock by itself,
+ * since erasing frees a node a searcher may be on.  Inserts don't look for the element first, so it can be in the list more than once.
+ */
+struct container{
+	
+	//Constructors/Destructor.
+	container() : delete_lock(), insert_lock(), size_lock(), ctnr() {}
+	container(const container&) = delete;
+	container(container&&) = delete;
+	~container() = default;
+	
+	//Assignment Operators.
+	container& operator=(const container&) = delete;
+	container& operator=(container&&) = delete;
+	
+	//Container Functions.
+	std::list<int>::iterator find(int x);
+	bool contains(int x);
+	bool insert(int x);
+	bool remove(int x);
+	
+	//Synchronization Members.
+	std::shared_mutex delete_lock;
+	std::mutex insert_lock;
+	std::mutex size_lock;
+	
+	//Mutable Members.
+	std::list<int> ctnr;
+
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include <thread>
+#include "cpp/shared/coroutine.hpp"
+
+namespace{
+
+thread_local co_scheduler* this_scheduler = NULL;
+
+}
+
+
+
+//----------Task Functions----------
+
+void co_task::promise_type::final_awaiter::await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+	co_scheduler* scheduler = h.promise().scheduler;
+	h.destroy();
+	scheduler->finished();
+}
+
+
+
+//----------Scheduler Functions----------
+
+co_scheduler* co_scheduler::current(){
+	return this_scheduler;
+}
+
+void co_scheduler::spawn(co_task t){
+	std::coroutine_handle<co_task::promise_type> h = std::exchange(t.handle, nullptr);
+	h.promise().scheduler = this;
+	
+	std::unique_lock lk(lock);
+	++outstanding;
+	ready.push_back(h);
+	has_work.notify_one();
+}
+
+void co_scheduler::schedule(std::coroutine_handle<> h){
+	std::unique_lock lk(lock);
+	
+	ready.push_back(h);
+	has_work.notify_one();
+}
+
+void co_scheduler::schedule_at(clock::time_point when, std::coroutine_handle<> h){
+	std::unique_lock lk(lock);
+	
+	timers.push(timer{when, timer_sequence++, h});
+	has_work.notify_one();		//The new timer might be due before whatever the sleeping threads are waiting for.
+}
+
+void co_scheduler::finished(){
+	std::unique_lock lk(lock);
+	
+	if(--outstanding == 0){
+		has_work.notify_all();
+	}
+}
+
+void co_scheduler::run(){
+	std::vector<std::thread> helpers;
+	for(int i = 1; i < threads; ++i){
+		helpers.push_back(std::thread(&co_scheduler::work, this));
+	}
+	work();
+	for(auto i = helpers.begin(); i != helpers.end(); ++i){
+		if(i->joinable()){
+			i->join();
+		}
+	}
+}
+
+void co_scheduler::work(){
+	co_scheduler* previous = this_scheduler;
+	this_scheduler = this;
+	
+	std::unique_lock lk(lock);
+	while(true){
+		clock::time_point now = clock::now();
+		while(!timers.empty() && timers.top().when <= now){
+			ready.push_back(timers.top().handle);
+			timers.pop();
+		}
+		
+		if(!ready.empty()){
+			std::coroutine_handle<> h = ready.front();
+			ready.pop_front();
+			lk.unlock();
+			h.resume();
+			lk.lock();
+		}else if(outstanding == 0){
+			break;
+		}else if(!timers.empty()){
+			has_work.wait_until(lk, timers.top().when);
+		}else{
+			has_work.wait(lk);
+		}
+	}
+	
+	this_scheduler = previous;
+}
+
+
+
+//----------Semaphore Functions----------
+
+bool co_semaphore::awaiter::await_ready(){
+	std::unique_lock lk(sem.lock);
+	
+	if(sem.head == NULL && sem.value >= n){		//Don't jump the queue.
+		sem.value -= n;
+		return true;
+	}
+	return false;
+}
+
+bool co_semaphore::awaiter::await_suspend(std::coroutine_handle<> h){
+	std::unique_lock lk(sem.lock);
+	
+	if(sem.head == NULL && sem.value >= n){		//Signalled since await_ready.
+		sem.value -= n;
+		return false;
+	}
+	
+	handle = h;
+	scheduler = co_scheduler::current();
+	if(sem.tail != NULL){
+		sem.tail->next = this;
+	}else{
+		sem.head = this;
+	}
+	sem.tail = this;
+	return true;
+}
+
+void co_semaphore::signal(int n){
+	std::unique_lock lk(lock);
+	
+	value += n;
+	awaiter* woken = NULL;
+	awaiter* woken_tail = NULL;
+	while(head != NULL && head->n <= value){
+		awaiter* waiter = head;
+		value -= waiter->n;
+		head = waiter->next;
+		waiter->next = NULL;
+		if(woken_tail != NULL){
+			woken_tail->next = waiter;
+		}else{
+			woken = waiter;
+		}
+		woken_tail = waiter;
+	}
+	if(head == NULL){
+		tail = NULL;
+	}
+	lk.unlock();
+	
+	while(woken != NULL){
+		awaiter* next = woken->next;		//Read this first, the waiter's frame may be gone as soon as it's resumed.
+		woken->scheduler->schedule(woken->handle);
+		woken = next;
+	}
+}
\ No newline at end of file
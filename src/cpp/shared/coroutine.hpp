@@ -0,0 +1,362 @@
+#ifndef COROUTINE_H_INCLUDED
+#define COROUTINE_H_INCLUDED
+
+#include <mutex>
+#include <deque>
+#include <queue>
+#include <chrono>
+#include <vector>
+#include <utility>
+#include <optional>
+#include <exception>
+#include <coroutine>
+#include <functional>
+#include <type_traits>
+#include <condition_variable>
+
+class co_scheduler;
+
+/*
+ * A detached actor coroutine.  It does nothing until it's handed to co_scheduler::spawn, and it destroys itself when it finishes.
+ */
+class co_task{
+public:
+	
+	struct promise_type{
+		
+		struct final_awaiter{
+			bool await_ready() noexcept {return false;}
+			void await_suspend(std::coroutine_handle<promise_type>) noexcept;
+			void await_resume() noexcept {}
+		};
+		
+		co_task get_return_object() {return co_task(std::coroutine_handle<promise_type>::from_promise(*this));}
+		std::suspend_always initial_suspend() noexcept {return {};}
+		final_awaiter final_suspend() noexcept {return {};}
+		void return_void() {}
+		void unhandled_exception() {std::terminate();}
+		
+		co_scheduler* scheduler = NULL;
+	};
+	
+	//Constructors/Destructor.
+	co_task(co_task&& other) : handle(std::exchange(other.handle, nullptr)) {}
+	co_task(const co_task&) = delete;
+	~co_task() {if(handle){handle.destroy();}}
+	
+	//Assignment Operators.
+	co_task& operator=(const co_task&) = delete;
+	co_task& operator=(co_task&&) = delete;
+
+private:
+	
+	explicit co_task(std::coroutine_handle<promise_type> h) : handle(h) {}
+	
+	friend co_scheduler;
+	
+	std::coroutine_handle<promise_type> handle;
+
+};
+
+/*
+ * A lazily started coroutine which another coroutine can co_await for its result.
+ * Control transfers straight into it and straight back out again, without going through the scheduler.
+ */
+template <class T = void>
+class co_subtask{
+public:
+	
+	struct promise_base{
+		
+		struct final_awaiter{
+			bool await_ready() noexcept {return false;}
+			template <class P>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {return h.promise().continuation;}
+			void await_resume() noexcept {}
+		};
+		
+		std::suspend_always initial_suspend() noexcept {return {};}
+		final_awaiter final_suspend() noexcept {return {};}
+		void unhandled_exception() {std::terminate();}
+		
+		std::coroutine_handle<> continuation;
+	};
+	
+	struct value_promise : promise_base{
+		co_subtask get_return_object() {return co_subtask(std::coroutine_handle<value_promise>::from_promise(*this));}
+		void return_value(T v) {value.emplace(std::move(v));}
+		
+		std::optional<T> value;
+	};
+	
+	struct void_promise : promise_base{
+		co_subtask get_return_object() {return co_subtask(std::coroutine_handle<void_promise>::from_promise(*this));}
+		void return_void() {}
+	};
+	
+	using promise_type = std::conditional_t<std::is_void_v<T>, void_promise, value_promise>;
+	
+	//Constructors/Destructor.
+	co_subtask(co_subtask&& other) : handle(std::exchange(other.handle, nullptr)) {}
+	co_subtask(const co_subtask&) = delete;
+	~co_subtask() {if(handle){handle.destroy();}}
+	
+	//Assignment Operators.
+	co_subtask& operator=(const co_subtask&) = delete;
+	co_subtask& operator=(co_subtask&&) = delete;
+	
+	//Awaiter Functions.
+	bool await_ready() const noexcept {return false;}
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {handle.promise().continuation = caller; return handle;}
+	T await_resume() {if constexpr(!std::is_void_v<T>){return std::move(*handle.promise().value);}}
+
+private:
+	
+	explicit co_subtask(std::coroutine_handle<promise_type> h) : handle(h) {}
+	
+	std::coroutine_handle<promise_type> handle;
+
+};
+
+/*
+ * Runs co_tasks on one or more threads.  Suspended coroutines don't occupy a thread, so millions of actors can share a handful of cores.
+ */
+class co_scheduler{
+public:
+	
+	using clock = std::chrono::steady_clock;
+	
+	//Constructors/Destructor.
+	co_scheduler(int n = 1) : threads(n > 0 ? n : 1), lock(), has_work(), ready(), timers(), timer_sequence(0), outstanding(0) {}
+	co_scheduler(const co_scheduler&) = delete;
+	co_scheduler(co_scheduler&&) = delete;
+	~co_scheduler() = default;
+	
+	//Assignment Operators.
+	co_scheduler& operator=(const co_scheduler&) = delete;
+	co_scheduler& operator=(co_scheduler&&) = delete;
+	
+	//Scheduler Operations.
+	void spawn(co_task t);								//Takes ownership of an actor and makes it runnable.
+	void run();											//Runs actors on the calling thread plus (threads - 1) others, until every actor has finished.
+	void schedule(std::coroutine_handle<> h);			//Makes a suspended coroutine runnable.
+	void schedule_at(clock::time_point when, std::coroutine_handle<> h);
+	
+	//The scheduler (if any) running on the calling thread.
+	static co_scheduler* current();
+
+private:
+	
+	struct timer{
+		clock::time_point when;
+		unsigned long sequence;		//Keeps timers with the same deadline in FIFO order.
+		std::coroutine_handle<> handle;
+		
+		bool operator>(const timer& other) const {return when != other.when ? when > other.when : sequence > other.sequence;}
+	};
+	
+	friend co_task::promise_type::final_awaiter;
+	void finished();
+	void work();
+	
+	const int threads;
+	
+	std::mutex lock;
+	std::condition_variable has_work;
+	std::deque<std::coroutine_handle<>> ready;
+	std::priority_queue<timer, std::vector<timer>, std::greater<timer>> timers;
+	unsigned long timer_sequence;
+	long outstanding;		//Actors spawned but not yet finished.
+
+};
+
+/*
+ * Suspends the calling coroutine for (at least) the given time, without blocking its thread.
+ */
+class co_sleep_for{
+public:
+	
+	template <class Rep, class Period>
+	co_sleep_for(const std::chrono::duration<Rep, Period>& d) : wake(co_scheduler::clock::now() + std::chrono::duration_cast<co_scheduler::clock::duration>(d)) {}
+	
+	//Awaiter Functions.
+	bool await_ready() const {return co_scheduler::clock::now() >= wake;}
+	void await_suspend(std::coroutine_handle<> h) {co_scheduler::current()->schedule_at(wake, h);}
+	void await_resume() {}
+
+private:
+	
+	co_scheduler::clock::time_point wake;
+
+};
+
+/*
+ * A semaphore for coroutines.  co_await wait() suspends the coroutine instead of blocking its thread.
+ * Waiters are woken in FIFO order.  signal() never blocks, so plain functions can call it too.
+ */
+class co_semaphore{
+public:
+	
+	class awaiter{
+	public:
+		awaiter(co_semaphore& s, int count) : sem(s), n(count), handle(), scheduler(NULL), next(NULL) {}
+		
+		bool await_ready();
+		bool await_suspend(std::coroutine_handle<> h);
+		void await_resume() {}
+	
+	private:
+		friend co_semaphore;
+		
+		co_semaphore& sem;
+		const int n;
+		std::coroutine_handle<> handle;
+		co_scheduler* scheduler;
+		awaiter* next;		//Waiters form an intrusive list, so waiting never allocates.
+	};
+	
+	//Constructors/Destructor.
+	co_semaphore(int i = 0) : lock(), value(i >= 0 ? i : 0), head(NULL), tail(NULL) {}
+	co_semaphore(const co_semaphore&) = delete;
+	co_semaphore(co_semaphore&&) = delete;
+	~co_semaphore() = default;
+	
+	//Assignment Operators.
+	co_semaphore& operator=(const co_semaphore&) = delete;
+	co_semaphore& operator=(co_semaphore&&) = delete;
+	
+	//Semaphore Operations.
+	awaiter wait(int n = 1) {return awaiter(*this, n);}
+	void signal(int n = 1);
+
+private:
+	
+	std::mutex lock;
+	int value;
+	awaiter* head;
+	awaiter* tail;
+
+};
+
+/*
+ * A queue for coroutines, with the same semantics as ts_queue.  co_await dequeue(x) suspends while the queue is empty and open.
+ */
+template <class T>
+class co_queue{
+public:
+	
+	using value_type = T;
+	
+	class awaiter{
+	public:
+		awaiter(co_queue& q, value_type& r) : queue(q), ret(r), handle(), scheduler(NULL), next(NULL), ok(false) {}
+		
+		bool await_ready() {return false;}
+		bool await_suspend(std::coroutine_handle<> h);
+		bool await_resume() {return ok;}	//Returns false if the queue was closed and empty.
+	
+	private:
+		friend co_queue;
+		
+		co_queue& queue;
+		value_type& ret;
+		std::coroutine_handle<> handle;
+		co_scheduler* scheduler;
+		awaiter* next;
+		bool ok;
+	};
+	
+	//Constructors/Destructor.
+	co_queue(long max = -1) : lock(), items(), head(NULL), tail(NULL), is_closed(false), maximum(max) {}
+	co_queue(const co_queue&) = delete;
+	co_queue(co_queue&&) = delete;
+	~co_queue() {close();}
+	
+	//Assignment Operators.
+	co_queue& operator=(const co_queue&) = delete;
+	co_queue& operator=(co_queue&&) = delete;
+	
+	//Queue Operations.
+	bool enqueue(value_type elem);						//Adds an element to the end of the queue.  Fails if it's full or closed.
+	awaiter dequeue(value_type& ret) {return awaiter(*this, ret);}
+	void close();										//Closes the queue.  Prevents enqueues, wakes every waiting dequeuer.
+
+private:
+	
+	std::mutex lock;
+	std::deque<value_type> items;
+	awaiter* head;
+	awaiter* tail;
+	bool is_closed;
+	long maximum;
+
+};
+
+template <class T>
+bool co_queue<T>::awaiter::await_suspend(std::coroutine_handle<> h){
+	std::unique_lock lk(queue.lock);
+	
+	if(!queue.items.empty()){
+		ret = std::move(queue.items.front());
+		queue.items.pop_front();
+		ok = true;
+		return false;
+	}
+	if(queue.is_closed){
+		return false;
+	}
+	
+	handle = h;
+	scheduler = co_scheduler::current();
+	if(queue.tail != NULL){
+		queue.tail->next = this;
+	}else{
+		queue.head = this;
+	}
+	queue.tail = this;
+	return true;
+}
+
+template <class T>
+bool co_queue<T>::enqueue(value_type elem){
+	std::unique_lock lk(lock);
+	
+	if(is_closed || (maximum >= 0 && items.size() == std::size_t(maximum))){
+		return false;
+	}
+	
+	if(head == NULL){
+		items.push_back(std::move(elem));
+		return true;
+	}
+	
+	awaiter* waiter = head;		//Someone is already waiting, hand the element straight to them.
+	head = waiter->next;
+	if(head == NULL){
+		tail = NULL;
+	}
+	lk.unlock();
+	
+	waiter->ret = std::move(elem);
+	waiter->ok = true;
+	waiter->scheduler->schedule(waiter->handle);
+	return true;
+}
+
+template <class T>
+void co_queue<T>::close(){
+	std::unique_lock lk(lock);
+	
+	is_closed = true;
+	awaiter* waiter = head;
+	head = tail = NULL;
+	lk.unlock();
+	
+	while(waiter != NULL){
+		awaiter* next = waiter->next;
+		waiter->scheduler->schedule(waiter->handle);
+		waiter = next;
+	}
+}
+
+#endif
\ No newline at end of file
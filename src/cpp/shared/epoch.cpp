@@ -0,0 +1,135 @@
+#include <deque>
+#include <atomic>
+#include <cstdint>
+#include "cpp/shared/epoch.hpp"
+
+namespace{
+
+constexpr int collect_period = 64;		//How many retires go by between attempts to move the epoch on.
+
+struct retired_node{
+	void* p;
+	void (*reclaim)(void*);
+	std::uint64_t epoch;		//The global epoch when it was retired.  Safe to free once the epoch is two past that.
+};
+
+struct thread_record{
+	std::atomic<std::uint64_t> state{0};		//The epoch the thread is pinned in, shifted left one with the low bit set, or zero if it isn't pinned.
+	std::atomic<bool> in_use{true};
+	thread_record* next = nullptr;				//Records are never unlinked or freed, only handed on.
+	
+	//Only touched by the thread which owns the record.
+	std::deque<retired_node> limbo;
+	int depth = 0;
+	int since_collect = 0;
+};
+
+std::atomic<std::uint64_t> global_epoch(0);
+std::atomic<thread_record*> records(nullptr);
+
+bool try_advance(){
+	std::uint64_t e = global_epoch.load();
+	for(thread_record* r = records.load(std::memory_order_acquire); r != nullptr; r = r->next){
+		std::uint64_t s = r->state.load();
+		if((s & 1) != 0 && (s >> 1) != e){
+			return false;
+		}
+	}
+	return global_epoch.compare_exchange_strong(e, e + 1);
+}
+
+void collect(thread_record* r){
+	try_advance();
+	std::uint64_t e = global_epoch.load();
+	while(!r->limbo.empty() && r->limbo.front().epoch + 2 <= e){
+		retired_node n = r->limbo.front();
+		r->limbo.pop_front();
+		n.reclaim(n.p);
+	}
+}
+
+/*
+ * The calling thread's record, claimed the first time it's needed.  A released record is reused before a new one gets made,
+ * so the list stays as long as the most threads that have ever used it at once (e.g. the biggest a thread_pool has grown).
+ */
+class record_owner{
+public:
+	
+	record_owner() : rec(nullptr) {}
+	~record_owner();
+	
+	thread_record* get();
+
+private:
+	
+	thread_record* rec;
+
+};
+
+thread_record* record_owner::get(){
+	if(rec != nullptr){
+		return rec;
+	}
+	
+	for(thread_record* r = records.load(std::memory_order_acquire); r != nullptr; r = r->next){
+		bool expected = false;
+		if(!r->in_use.load(std::memory_order_relaxed) && r->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)){
+			rec = r;
+			return rec;
+		}
+	}
+	
+	rec = new thread_record();
+	thread_record* top = records.load(std::memory_order_relaxed);
+	do{
+		rec->next = top;
+	}while(!records.compare_exchange_weak(top, rec, std::memory_order_release, std::memory_order_relaxed));
+	return rec;
+}
+
+record_owner::~record_owner(){
+	if(rec != nullptr){
+		collect(rec);		//Whatever isn't safe yet stays in the record's limbo list for the next thread to free.
+		rec->in_use.store(false, std::memory_order_release);
+	}
+}
+
+thread_local record_owner this_thread;
+
+}
+
+
+
+//----------Guard Functions----------
+
+epoch_guard::epoch_guard(){
+	thread_record* r = this_thread.get();
+	if(r->depth++ == 0){
+		r->state.store(global_epoch.load() << 1 | 1);		//If the epoch moves on in between, this only holds it back until the guard goes.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+}
+
+epoch_guard::~epoch_guard(){
+	thread_record* r = this_thread.get();
+	if(--r->depth == 0){
+		r->state.store(0, std::memory_order_release);
+	}
+}
+
+
+
+//----------Reclamation Functions----------
+
+void epoch_retire(void* p, void (*reclaim)(void*)){
+	thread_record* r = this_thread.get();
+	r->limbo.push_back({p, reclaim, global_epoch.load()});
+	if(++r->since_collect >= collect_period){
+		r->since_collect = 0;
+		collect(r);
+	}
+}
+
+void epoch_collect(){
+	collect(this_thread.get());
+}
\ No newline at end of file
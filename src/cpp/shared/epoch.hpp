@@ -0,0 +1,35 @@
+#ifndef EPOCH_H_INCLUDED
+#define EPOCH_H_INCLUDED
+
+/*
+ * Epoch-based reclamation, for lock-free containers whose readers walk nodes that a writer may unlink at any time.
+ * Readers hold an epoch_guard while they touch shared nodes, and writers hand unlinked nodes to epoch_retire() instead of deleting them.
+ * A global epoch only moves forward once every guarded thread has seen the current one, so anything retired two epochs ago
+ * can't be reachable by anyone any more, and gets freed.  Retired nodes wait in the retiring thread's limbo list until then.
+ * Threads register themselves on first use, and a thread's record (limbo list included) is handed on to a later thread once it exits.
+ */
+class epoch_guard{
+public:
+	
+	//Constructors/Destructor.  Guards nest, only the outermost one pins the thread.
+	epoch_guard();
+	epoch_guard(const epoch_guard&) = delete;
+	epoch_guard(epoch_guard&&) = delete;
+	~epoch_guard();
+	
+	//Assignment Operators.
+	epoch_guard& operator=(const epoch_guard&) = delete;
+	epoch_guard& operator=(epoch_guard&&) = delete;
+
+};
+
+//Reclamation Functions.
+void epoch_retire(void* p, void (*reclaim)(void*));		//Calls reclaim(p) once no guard taken before now is still alive.
+void epoch_collect();									//Tries to move the epoch on, and frees whatever that makes safe.  Done every so often by epoch_retire too.
+
+template <class T>
+void epoch_retire(T* p){
+	epoch_retire(p, [](void* q){delete static_cast<T*>(q);});
+}
+
+#endif
\ No newline at end of file
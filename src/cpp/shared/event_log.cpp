@@ -0,0 +1,180 @@
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <iostream>
+#include <algorithm>
+#include <condition_variable>
+#include "cpp/shared/event_log.hpp"
+
+namespace{
+
+constexpr std::size_t buffer_capacity = 4096;
+constexpr std::chrono::milliseconds drain_period(1);
+
+/*
+ * A single-producer/single-consumer ring of records.  The owning thread is the producer, the drainer is the consumer.
+ */
+struct event_buffer{
+	event_buffer() : records(), head(0), tail(0), retired(false) {}
+	
+	event_record records[buffer_capacity];
+	std::atomic<std::size_t> head;		//Next record to drain.
+	std::atomic<std::size_t> tail;		//Next record to write.
+	std::atomic<bool> retired;			//Set once the owning thread has exited.
+};
+
+/*
+ * Marks a thread's buffer as retired when the thread exits, so the drainer can drop it once it's empty.
+ */
+struct buffer_handle{
+	~buffer_handle() {if(buffer){buffer->retired.store(true);}}
+	
+	std::shared_ptr<event_buffer> buffer;
+};
+
+class drainer{
+public:
+	
+	//Constructors/Destructor.
+	drainer() : lock(), output_lock(), wake(), buffers(), worker(), stopping(false) {}
+	drainer(const drainer&) = delete;
+	drainer(drainer&&) = delete;
+	~drainer() = default;
+	
+	//Assignment Operators.
+	drainer& operator=(const drainer&) = delete;
+	drainer& operator=(drainer&&) = delete;
+	
+	//Drainer Operations.
+	std::shared_ptr<event_buffer> attach();
+	void drain();
+	void stop();
+
+private:
+	
+	void run();
+	
+	std::mutex lock;			//Protects buffers, worker, and stopping.
+	std::mutex output_lock;		//Keeps whole drain passes from interleaving.
+	std::condition_variable wake;
+	std::vector<std::shared_ptr<event_buffer>> buffers;
+	std::thread worker;
+	bool stopping;
+
+};
+
+drainer& the_drainer(){
+	static drainer* instance = new drainer();	//Never destroyed, so detached threads can keep logging during static destruction.
+	return *instance;
+}
+
+thread_local buffer_handle this_thread_buffer;
+
+std::shared_ptr<event_buffer> drainer::attach(){
+	std::unique_lock lk(lock);
+	
+	if(!worker.joinable() && !stopping){
+		worker = std::thread(&drainer::run, this);
+		std::atexit([](){the_drainer().stop();});
+	}
+	buffers.push_back(std::make_shared<event_buffer>());
+	return buffers.back();
+}
+
+void drainer::drain(){
+	std::unique_lock out_lk(output_lock);
+	std::vector<event_record> batch;
+	
+	{
+		std::unique_lock lk(lock);
+		for(auto i = buffers.begin(); i != buffers.end();){
+			event_buffer& buf = **i;
+			std::size_t head = buf.head.load(std::memory_order_relaxed);
+			std::size_t tail = buf.tail.load(std::memory_order_acquire);
+			for(; head != tail; ++head){
+				batch.push_back(buf.records[head % buffer_capacity]);
+			}
+			buf.head.store(head, std::memory_order_release);
+			
+			if(buf.retired.load() && head == buf.tail.load(std::memory_order_acquire)){
+				i = buffers.erase(i);
+			}else{
+				++i;
+			}
+		}
+	}
+	if(batch.empty()){
+		return;
+	}
+	
+	std::stable_sort(batch.begin(), batch.end(), [](const event_record& a, const event_record& b){return a.time < b.time;});
+	
+	std::string text;
+	char line[256];
+	for(auto i = batch.begin(); i != batch.end(); ++i){
+		int length = std::snprintf(line, sizeof(line), i->format, i->args[0], i->args[1]);
+		if(length > 0){
+			text.append(line, std::min(std::size_t(length), sizeof(line) - 1));
+		}
+	}
+	std::cout.write(text.data(), text.size());
+	std::cout.flush();
+}
+
+void drainer::stop(){
+	{
+		std::unique_lock lk(lock);
+		stopping = true;
+		wake.notify_all();
+	}
+	if(worker.joinable()){
+		worker.join();
+	}
+	drain();
+}
+
+void drainer::run(){
+	std::unique_lock lk(lock);
+	while(!stopping){
+		wake.wait_for(lk, drain_period);
+		lk.unlock();
+		drain();
+		lk.lock();
+	}
+}
+
+}
+
+
+
+//----------Event Log Functions----------
+
+void event_log::record(const char* format, int first, int second){
+	if(!this_thread_buffer.buffer){
+		this_thread_buffer.buffer = the_drainer().attach();
+	}
+	event_buffer& buf = *this_thread_buffer.buffer;
+	
+	std::size_t tail = buf.tail.load(std::memory_order_relaxed);
+	while(tail - buf.head.load(std::memory_order_acquire) == buffer_capacity){
+		std::this_thread::yield();		//Full, wait for the drainer to catch up.
+	}
+	
+	event_record& rec = buf.records[tail % buffer_capacity];
+	rec.time = std::chrono::steady_clock::now().time_since_epoch().count();
+	rec.format = format;
+	rec.args[0] = first;
+	rec.args[1] = second;
+	buf.tail.store(tail + 1, std::memory_order_release);
+}
+
+void event_log::flush(){
+	the_drainer().drain();
+}
\ No newline at end of file
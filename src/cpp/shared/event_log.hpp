@@ -0,0 +1,42 @@
+#ifndef EVENT_LOG_H_INCLUDED
+#define EVENT_LOG_H_INCLUDED
+
+#include <cstdint>
+
+//Compile with -DEVENT_LOG_LEVEL=0 to remove logging entirely (e.g. for benchmark builds).
+#ifndef EVENT_LOG_LEVEL
+#define EVENT_LOG_LEVEL 1
+#endif
+
+/*
+ * A single fixed-size log entry.  The format string is printf-style, takes at most two %d arguments, and must outlive the log (i.e. be a string literal).
+ */
+struct event_record{
+	std::int64_t time;
+	const char* format;
+	int args[2];
+};
+
+/*
+ * A non-blocking replacement for locking a global mutex around std::cout.
+ * Each thread appends binary records to its own lock-free buffer, and a background thread periodically drains every buffer,
+ * orders the records by time, formats them, and writes them out in one batch.  Whatever is left is drained when the program exits.
+ */
+class event_log{
+public:
+	
+	//Logging Operations.
+	static void record(const char* format, int first, int second);	//Appends a record to the calling thread's buffer.  Only blocks if that buffer is full.
+	static void flush();											//Formats and writes out everything recorded so far.
+
+};
+
+inline void log_event(const char* format, int first = 0, int second = 0){
+#if EVENT_LOG_LEVEL > 0
+	event_log::record(format, first, second);
+#else
+	(void)format; (void)first; (void)second;
+#endif
+}
+
+#endif
\ No newline at end of file
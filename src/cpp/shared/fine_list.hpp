@@ -0,0 +1,260 @@
+#ifndef FINE_LIST_H_INCLUDED
+#define FINE_LIST_H_INCLUDED
+
+#include <mutex>
+#include <atomic>
+#include "cpp/shared/epoch.hpp"
+
+/*
+ * This object represents an ordered set, kept as a singly-linked list with a lock in every node, walked hand-over-hand:
+ * the next node is always locked before the current one is let go of, so nobody can slip in between the two.
+ * Writers only hold the two nodes around the spot they're changing, so writers on disjoint parts of the list can get through together,
+ * but nobody can overtake anyone on the way there.  Nothing can be standing on an unlinked node, so it's freed straight away.
+ */
+template <class T>
+class coupled_list {
+public:
+	
+	using value_type = T;
+	
+	//Constructors/Destructor
+	coupled_list() : head() {}
+	coupled_list(const coupled_list&) = delete;
+	coupled_list(coupled_list&&) = delete;
+	~coupled_list();
+	
+	//Assignment Operators
+	coupled_list& operator=(const coupled_list&) = delete;
+	coupled_list& operator=(coupled_list&&) = delete;
+	
+	//Set Operations
+	bool contains(const value_type&);			//Returns whether or not the element is in the set.
+	bool insert(const value_type&);				//Adds the element.  Fails if it's already there.
+	bool remove(const value_type&);				//Removes the element.  Fails if it isn't there.
+
+private:
+	
+	struct node{
+		node() : value(), next(nullptr), lock() {}
+		node(const value_type& v, node* n) : value(v), next(n), lock() {}
+		
+		value_type value;
+		node* next;			//Only read or written with this node locked.
+		std::mutex lock;
+	};
+	
+	//Walks to the last node before the element and the first node at or after it (or null), and returns with both of them locked.
+	void locate(const value_type&, node*& pred, node*& curr);
+	static void release(node* pred, node* curr);
+	
+	node head;		//A sentinel.
+
+};
+
+/*
+ * The optimistic version, as a lazy list.  Writers walk to their spot without locking anything, lock the two nodes there,
+ * and then check that neither has been removed and they're still next to each other, starting over if not.
+ * Removal marks a node before unlinking it, so searches don't lock anything at all: an element is there if it's reachable and unmarked.
+ * Searchers may still be walking through an unlinked node, so those go to epoch_retire().
+ */
+template <class T>
+class lazy_list {
+public:
+	
+	using value_type = T;
+	
+	//Constructors/Destructor
+	lazy_list() : head() {}
+	lazy_list(const lazy_list&) = delete;
+	lazy_list(lazy_list&&) = delete;
+	~lazy_list();
+	
+	//Assignment Operators
+	lazy_list& operator=(const lazy_list&) = delete;
+	lazy_list& operator=(lazy_list&&) = delete;
+	
+	//Set Operations
+	bool contains(const value_type&) const;		//Returns whether or not the element is in the set.  Wait-free.
+	bool insert(const value_type&);				//Adds the element.  Fails if it's already there.
+	bool remove(const value_type&);				//Removes the element.  Fails if it isn't there.
+
+private:
+	
+	struct node{
+		node() : value(), next(nullptr), marked(false), lock() {}
+		node(const value_type& v, node* n) : value(v), next(n), marked(false), lock() {}
+		
+		value_type value;
+		std::atomic<node*> next;
+		std::atomic<bool> marked;		//Logically removed.
+		std::mutex lock;
+	};
+	
+	//Walks to the last node before the element and the first node at or after it (or null), and returns with both of them locked
+	//and checked.  Needs a guard.
+	void locate(const value_type&, node*& pred, node*& curr);
+	static void release(node* pred, node* curr);
+	
+	node head;		//A sentinel, never marked.
+
+};
+
+template <class T>
+coupled_list<T>::~coupled_list(){
+	node* n = head.next;
+	while(n != nullptr){
+		node* next = n->next;
+		delete n;
+		n = next;
+	}
+}
+
+template <class T>
+void coupled_list<T>::locate(const value_type& x, node*& pred, node*& curr){
+	pred = &head;
+	pred->lock.lock();
+	curr = pred->next;
+	if(curr != nullptr){
+		curr->lock.lock();
+	}
+	while(curr != nullptr && curr->value < x){
+		node* next = curr->next;
+		if(next != nullptr){
+			next->lock.lock();
+		}
+		pred->lock.unlock();
+		pred = curr;
+		curr = next;
+	}
+}
+
+template <class T>
+void coupled_list<T>::release(node* pred, node* curr){
+	if(curr != nullptr){
+		curr->lock.unlock();
+	}
+	pred->lock.unlock();
+}
+
+template <class T>
+bool coupled_list<T>::contains(const value_type& x){
+	node* pred;
+	node* curr;
+	locate(x, pred, curr);
+	bool found = curr != nullptr && !(x < curr->value);
+	release(pred, curr);
+	return found;
+}
+
+template <class T>
+bool coupled_list<T>::insert(const value_type& x){
+	node* pred;
+	node* curr;
+	locate(x, pred, curr);
+	bool added = curr == nullptr || x < curr->value;
+	if(added){
+		pred->next = new node(x, curr);
+	}
+	release(pred, curr);
+	return added;
+}
+
+template <class T>
+bool coupled_list<T>::remove(const value_type& x){
+	node* pred;
+	node* curr;
+	locate(x, pred, curr);
+	if(curr == nullptr || x < curr->value){
+		release(pred, curr);
+		return false;
+	}
+	
+	pred->next = curr->next;
+	curr->lock.unlock();		//Anyone after it would have had to get past pred first.
+	pred->lock.unlock();
+	delete curr;
+	return true;
+}
+
+template <class T>
+lazy_list<T>::~lazy_list(){
+	node* n = head.next.load();
+	while(n != nullptr){
+		node* next = n->next.load();
+		delete n;
+		n = next;
+	}
+}
+
+template <class T>
+void lazy_list<T>::locate(const value_type& x, node*& pred, node*& curr){
+	while(true){
+		pred = &head;
+		curr = pred->next.load(std::memory_order_acquire);
+		while(curr != nullptr && curr->value < x){
+			pred = curr;
+			curr = curr->next.load(std::memory_order_acquire);
+		}
+		
+		pred->lock.lock();
+		if(curr != nullptr){
+			curr->lock.lock();
+		}
+		if(!pred->marked.load() && (curr == nullptr || !curr->marked.load()) && pred->next.load() == curr){
+			return;
+		}
+		release(pred, curr);
+	}
+}
+
+template <class T>
+void lazy_list<T>::release(node* pred, node* curr){
+	if(curr != nullptr){
+		curr->lock.unlock();
+	}
+	pred->lock.unlock();
+}
+
+template <class T>
+bool lazy_list<T>::contains(const value_type& x) const{
+	epoch_guard guard;
+	node* curr = head.next.load(std::memory_order_acquire);
+	while(curr != nullptr && curr->value < x){
+		curr = curr->next.load(std::memory_order_acquire);
+	}
+	return curr != nullptr && !(x < curr->value) && !curr->marked.load(std::memory_order_acquire);
+}
+
+template <class T>
+bool lazy_list<T>::insert(const value_type& x){
+	epoch_guard guard;
+	node* pred;
+	node* curr;
+	locate(x, pred, curr);
+	bool added = curr == nullptr || x < curr->value;
+	if(added){
+		pred->next.store(new node(x, curr), std::memory_order_release);
+	}
+	release(pred, curr);
+	return added;
+}
+
+template <class T>
+bool lazy_list<T>::remove(const value_type& x){
+	epoch_guard guard;
+	node* pred;
+	node* curr;
+	locate(x, pred, curr);
+	if(curr == nullptr || x < curr->value){
+		release(pred, curr);
+		return false;
+	}
+	
+	curr->marked.store(true, std::memory_order_release);
+	pred->next.store(curr->next.load(), std::memory_order_release);
+	release(pred, curr);
+	epoch_retire(curr);
+	return true;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include <bit>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include "cpp/shared/latency.hpp"
+
+namespace{
+
+std::mutex& registry_lock(){
+	static std::mutex lock;
+	return lock;
+}
+
+std::vector<latency_histogram*>& registry(){
+	static std::vector<latency_histogram*> histograms;
+	return histograms;
+}
+
+}
+
+
+
+//----------Constructor----------
+
+latency_histogram::latency_histogram(const char* l, bool registered) : name(), buckets(), total(0), maximum(0) {
+	std::strncpy(name, l != NULL ? l : "unnamed", label_size - 1);
+	
+	if(l != NULL && registered){
+		std::unique_lock lk(registry_lock());
+		registry().push_back(this);
+	}
+}
+
+
+
+//----------Recording Functions----------
+
+void latency_histogram::record(long long nanoseconds){
+	if(nanoseconds < 0){
+		nanoseconds = 0;
+	}
+	buckets[bucket_of(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+	total.fetch_add(1, std::memory_order_relaxed);
+	
+	long long seen = maximum.load(std::memory_order_relaxed);
+	while(nanoseconds > seen && !maximum.compare_exchange_weak(seen, nanoseconds, std::memory_order_relaxed)){}
+}
+
+void latency_histogram::merge(const latency_histogram& other){
+	for(int i = 0; i < total_buckets; ++i){
+		long long c = other.buckets[i].load(std::memory_order_relaxed);
+		if(c != 0){
+			buckets[i].fetch_add(c, std::memory_order_relaxed);
+		}
+	}
+	total.fetch_add(other.total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	
+	long long other_max = other.maximum.load(std::memory_order_relaxed);
+	long long seen = maximum.load(std::memory_order_relaxed);
+	while(other_max > seen && !maximum.compare_exchange_weak(seen, other_max, std::memory_order_relaxed)){}
+}
+
+void latency_histogram::reset(){
+	for(int i = 0; i < total_buckets; ++i){
+		buckets[i].store(0, std::memory_order_relaxed);
+	}
+	total.store(0, std::memory_order_relaxed);
+	maximum.store(0, std::memory_order_relaxed);
+}
+
+
+
+//----------Query Functions----------
+
+long long latency_histogram::count() const{
+	return total.load(std::memory_order_relaxed);
+}
+
+long long latency_histogram::max() const{
+	return maximum.load(std::memory_order_relaxed);
+}
+
+long long latency_histogram::percentile(double p) const{
+	long long n = count();
+	if(n == 0){
+		return 0;
+	}
+	
+	long long rank = static_cast<long long>(p / 100.0 * n + 0.5);		//The rank'th smallest sample (1-based).
+	if(rank < 1){
+		rank = 1;
+	}else if(rank > n){
+		rank = n;
+	}
+	
+	long long seen = 0;
+	for(int i = 0; i < total_buckets; ++i){
+		seen += buckets[i].load(std::memory_order_relaxed);
+		if(seen >= rank){
+			return std::min(bucket_limit(i), max());
+		}
+	}
+	return max();
+}
+
+
+
+//----------Serialization Functions----------
+
+void latency_histogram::write(std::ostream& out) const{
+	out << name << " " << count() << " " << max();
+	for(int i = 0; i < total_buckets; ++i){
+		long long c = buckets[i].load(std::memory_order_relaxed);
+		if(c != 0){
+			out << " " << i << ":" << c;
+		}
+	}
+	out << "\n";
+}
+
+bool latency_histogram::read(std::istream& in){
+	std::string line;
+	if(!std::getline(in, line)){
+		return false;
+	}
+	
+	std::stringstream fields(line);
+	std::string l;
+	long long n, m;
+	if(!(fields >> l >> n >> m)){
+		return false;
+	}
+	std::strncpy(name, l.c_str(), label_size - 1);
+	
+	int index;
+	char colon;
+	long long c;
+	while(fields >> index >> colon >> c){
+		if(index >= 0 && index < total_buckets){
+			buckets[index].fetch_add(c, std::memory_order_relaxed);
+		}
+	}
+	total.fetch_add(n, std::memory_order_relaxed);
+	
+	long long seen = maximum.load(std::memory_order_relaxed);
+	while(m > seen && !maximum.compare_exchange_weak(seen, m, std::memory_order_relaxed)){}
+	return true;
+}
+
+
+
+//----------Report Functions----------
+
+void write_latency_report(){
+	const char* path = std::getenv("LATENCY_REPORT");
+	if(path == NULL || *path == '\0'){
+		return;
+	}
+	
+	std::unique_lock lk(registry_lock());
+	std::ofstream out(path, std::ios::app);
+	for(auto i = registry().begin(); i != registry().end(); ++i){
+		(*i)->write(out);
+	}
+}
+
+
+
+//----------Bucket Functions----------
+
+int latency_histogram::bucket_of(long long nanoseconds){
+	unsigned long long v = nanoseconds;
+	if(v < sub_buckets){
+		return v;
+	}
+	
+	int msb = std::bit_width(v) - 1;
+	int shift = msb - sub_bucket_bits;
+	return (shift + 1) * sub_buckets + ((v >> shift) & (sub_buckets - 1));
+}
+
+long long latency_histogram::bucket_limit(int bucket){
+	if(bucket < sub_buckets){
+		return bucket;
+	}
+	
+	int shift = bucket / sub_buckets - 1;
+	long long low = static_cast<long long>(sub_buckets + bucket % sub_buckets) << shift;
+	return low + (1LL << shift) - 1;
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef LATENCY_H_INCLUDED
+#define LATENCY_H_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+
+/*
+ * A fixed-size, lock-free latency histogram.  Buckets are log-linear: every power of two is split into sub_buckets equal
+ * slices, so a reported percentile is never more than about 6% above the true value, and recording is one relaxed increment.
+ * Histograms constructed with a label register themselves, and if the LATENCY_REPORT environment variable names a file,
+ * write_latency_report() appends every registered histogram to that file (see bench/scenario_bench.cpp).
+ */
+class latency_histogram{
+public:
+	
+	using clock = std::chrono::steady_clock;
+	
+	static constexpr int sub_bucket_bits = 4;
+	static constexpr int sub_buckets = 1 << sub_bucket_bits;
+	static constexpr int total_buckets = (64 - sub_bucket_bits) * sub_buckets;
+	static constexpr int label_size = 32;
+	
+	//Constructors/Destructor.
+	explicit latency_histogram(const char* l = NULL, bool registered = true);
+	latency_histogram(const latency_histogram&) = delete;
+	latency_histogram(latency_histogram&&) = delete;
+	~latency_histogram() = default;
+	
+	//Assignment Operators.
+	latency_histogram& operator=(const latency_histogram&) = delete;
+	latency_histogram& operator=(latency_histogram&&) = delete;
+	
+	//Recording Operations.
+	void record(long long nanoseconds);
+	void record_since(clock::time_point start) {record(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());}
+	void merge(const latency_histogram& other);
+	void reset();
+	
+	//Query Operations.  Percentiles are given out of 100, and come back in nanoseconds.
+	const char* label() const {return name;}
+	long long count() const;
+	long long max() const;
+	long long percentile(double p) const;
+	
+	//Serialization.  One line: the label, the count, the maximum, then index:count for every non-empty bucket.
+	void write(std::ostream& out) const;
+	bool read(std::istream& in);		//Merges a line written by write() into this histogram, and takes its label.
+
+private:
+	
+	static int bucket_of(long long nanoseconds);
+	static long long bucket_limit(int bucket);		//The largest value that lands in the bucket.
+	
+	char name[label_size];
+	std::atomic<long long> buckets[total_buckets];
+	std::atomic<long long> total;
+	std::atomic<long long> maximum;
+
+};
+
+//Appends every registered histogram to the LATENCY_REPORT file, if it's set.  Call it from main, while the histograms are still alive.
+void write_latency_report();
+
+#endif
\ No newline at end of file
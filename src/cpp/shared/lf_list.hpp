@@ -0,0 +1,157 @@
+#ifndef LF_LIST_H_INCLUDED
+#define LF_LIST_H_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include "cpp/shared/epoch.hpp"
+
+/*
+ * This object represents a lock-free, ordered set, kept as a singly-linked list (Harris's algorithm, with Michael's tweaks).
+ * A node is deleted in two steps: first the low bit of its own next pointer is set (logically deleted, so nothing can be linked after it),
+ * then it's unlinked from its predecessor, by the remover or by whichever traversal trips over it first.
+ * Searches never write and never retry, so they're wait-free, and inserts and removes only retry when a CAS on a neighbouring pointer loses.
+ * Every operation holds an epoch_guard, and unlinked nodes go to epoch_retire(), so they're only freed once no searcher can still be standing on them.
+ */
+template <class T>
+class lf_list {
+public:
+	
+	using value_type = T;
+	
+	//Constructors/Destructor
+	lf_list() : head() {}
+	lf_list(const lf_list&) = delete;
+	lf_list(lf_list&&) = delete;
+	~lf_list();
+	
+	//Assignment Operators
+	lf_list& operator=(const lf_list&) = delete;
+	lf_list& operator=(lf_list&&) = delete;
+	
+	//Set Operations
+	bool contains(const value_type&) const;		//Returns whether or not the element is in the set.  Wait-free.
+	bool insert(const value_type&);				//Adds the element.  Fails if it's already there.
+	bool remove(const value_type&);				//Removes the element.  Fails if it isn't there.
+
+private:
+	
+	struct node{
+		node() : value(), next(nullptr) {}
+		node(const value_type& v, node* n) : value(v), next(n) {}
+		
+		value_type value;
+		std::atomic<node*> next;		//The low bit is the deletion mark.
+	};
+	
+	static bool is_marked(node* p) {return (reinterpret_cast<std::uintptr_t>(p) & 1) != 0;}
+	static node* marked(node* p) {return reinterpret_cast<node*>(reinterpret_cast<std::uintptr_t>(p) | 1);}
+	static node* unmarked(node* p) {return reinterpret_cast<node*>(reinterpret_cast<std::uintptr_t>(p) & ~std::uintptr_t(1));}
+	
+	std::pair<node*, node*> find(const value_type&);		//The last node before the element and the first node at or after it, unlinking marked nodes on the way.  Needs a guard.
+	
+	node head;		//A sentinel, never marked.
+
+};
+
+template <class T>
+lf_list<T>::~lf_list(){
+	node* n = unmarked(head.next.load());
+	while(n != nullptr){
+		node* next = unmarked(n->next.load());
+		delete n;
+		n = next;
+	}
+}
+
+template <class T>
+bool lf_list<T>::contains(const value_type& x) const{
+	epoch_guard guard;
+	node* curr = unmarked(head.next.load(std::memory_order_acquire));
+	while(curr != nullptr && curr->value < x){
+		curr = unmarked(curr->next.load(std::memory_order_acquire));
+	}
+	return curr != nullptr && !(x < curr->value) && !is_marked(curr->next.load(std::memory_order_acquire));
+}
+
+template <class T>
+std::pair<typename lf_list<T>::node*, typename lf_list<T>::node*> lf_list<T>::find(const value_type& x){
+	while(true){
+		node* pred = &head;
+		node* curr = pred->next.load(std::memory_order_acquire);
+		bool restart = false;
+		while(curr != nullptr){
+			node* succ = curr->next.load(std::memory_order_acquire);
+			if(is_marked(succ)){
+				node* expected = curr;
+				if(!pred->next.compare_exchange_strong(expected, unmarked(succ))){
+					restart = true;		//pred was marked, or something was linked in after it.
+					break;
+				}
+				epoch_retire(curr);
+				curr = unmarked(succ);
+				continue;
+			}
+			if(!(curr->value < x)){
+				break;
+			}
+			pred = curr;
+			curr = succ;
+		}
+		if(!restart){
+			return {pred, curr};
+		}
+	}
+}
+
+template <class T>
+bool lf_list<T>::insert(const value_type& x){
+	epoch_guard guard;
+	node* fresh = nullptr;
+	while(true){
+		auto [pred, curr] = find(x);
+		if(curr != nullptr && !(x < curr->value)){
+			delete fresh;
+			return false;
+		}
+		
+		if(fresh == nullptr){
+			fresh = new node(x, curr);
+		}else{
+			fresh->next.store(curr, std::memory_order_relaxed);
+		}
+		node* expected = curr;
+		if(pred->next.compare_exchange_strong(expected, fresh, std::memory_order_release)){
+			return true;
+		}
+	}
+}
+
+template <class T>
+bool lf_list<T>::remove(const value_type& x){
+	epoch_guard guard;
+	while(true){
+		auto [pred, curr] = find(x);
+		if(curr == nullptr || x < curr->value){
+			return false;
+		}
+		
+		node* succ = curr->next.load(std::memory_order_acquire);
+		if(is_marked(succ)){
+			continue;		//Someone else got there first, find() will unlink it and report it gone.
+		}
+		if(!curr->next.compare_exchange_strong(succ, marked(succ))){
+			continue;
+		}
+		
+		node* expected = curr;
+		if(pred->next.compare_exchange_strong(expected, succ)){
+			epoch_retire(curr);
+		}else{
+			find(x);		//Leaves the unlinking to a traversal.
+		}
+		return true;
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,199 @@
+#ifndef LF_QUEUE_H_INCLUDED
+#define LF_QUEUE_H_INCLUDED
+
+#include <new>
+#include <atomic>
+#include <thread>
+#include <cstddef>
+#include <utility>
+#include <stdexcept>
+#include "cpp/shared/thread_pool.hpp"
+
+/*
+ * This object represents a lock-free, bounded, multi-producer/multi-consumer queue.
+ * It has the same enqueue/dequeue/close semantics as ts_queue, but it is backed by a preallocated ring of slots, so unlike ts_queue
+ * it can't be unbounded: the capacity has to be given up front.
+ * Each slot carries a sequence number which tells producers and consumers whose turn it is to use it.
+ * Consumers only block (on an atomic, futex-style) after spinning on an empty queue for a while.
+ */
+template <class T>
+class lf_queue {
+public:
+
+	using value_type = T;
+
+	//Constructors/Destructor
+	explicit lf_queue(long max);		//Throws std::invalid_argument if max is negative, since the ring can't grow.
+	lf_queue(const lf_queue&) = delete;
+	lf_queue(lf_queue&&) = delete;
+	~lf_queue() {clear(); close(); delete [] slots;}
+
+	//Assignment Operators
+	lf_queue& operator=(const lf_queue&) = delete;
+	lf_queue& operator=(lf_queue&&) = delete;
+
+	//Queue Operations
+	bool empty() const;							//Returns whether or not the queue is empty.  Only a snapshot while other threads are active.
+	bool enqueue(const value_type&);			//Adds an element to the end of the queue.  Fails if the queue is full or closed.
+	bool dequeue(value_type&);					//Removes an element from the front of the queue.  Blocks if queue is not closed, doesn't otherwise.
+	void clear();								//Removes everything from the queue.
+
+	//Clean-up Operations
+	bool closed() const {return is_closed.load();}	//Returns whether or not the queue is closed.
+	void close();									//Closes the queue.  Prevents enqueues, makes dequeues non-blocking.
+
+private:
+
+	static constexpr int spin_limit = 64;
+
+	struct alignas(64) slot{
+		std::atomic<std::size_t> sequence;
+		alignas(value_type) unsigned char storage[sizeof(value_type)];
+
+		value_type* get() {return std::launder(reinterpret_cast<value_type*>(storage));}
+	};
+
+	bool try_pop(value_type&);
+
+	slot* slots;
+	const std::size_t size;
+
+	alignas(64) std::atomic<std::size_t> head;		//Next position to dequeue from.
+	alignas(64) std::atomic<std::size_t> tail;		//Next position to enqueue into.
+	alignas(64) std::atomic<unsigned> pushes;		//Bumped on every enqueue and on close, consumers sleep on this.
+	std::atomic<int> sleepers;
+	std::atomic<bool> is_closed;
+
+};
+
+template <class T>
+lf_queue<T>::lf_queue(long max) : slots(NULL), size(max >= 0 ? std::size_t(max) : 0), head(0), tail(0), pushes(0), sleepers(0), is_closed(false) {
+	if(max < 0){
+		throw std::invalid_argument("lf_queue needs a capacity, it can't be unbounded.");
+	}
+	slots = new slot[size];
+	for(std::size_t i = 0; i < size; ++i){
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+template <class T>
+bool lf_queue<T>::empty() const {
+	return head.load() >= tail.load();
+}
+
+template <class T>
+bool lf_queue<T>::enqueue(const value_type& elem){
+	if(is_closed.load() || size == 0){
+		return false;
+	}
+
+	std::size_t pos = tail.load(std::memory_order_relaxed);
+	slot* cell;
+	while(true){
+		cell = &slots[pos % size];
+		std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+		if(seq == pos){
+			if(tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+				break;
+			}
+		}else if(seq < pos){
+			return false;		//The slot still holds an element from the last lap, so the queue is full.
+		}else{
+			pos = tail.load(std::memory_order_relaxed);
+		}
+	}
+
+	new (cell->storage) value_type(elem);
+	cell->sequence.store(pos + 1, std::memory_order_release);
+
+	pushes.fetch_add(1);
+	if(sleepers.load() > 0){
+		pushes.notify_one();
+	}
+	return true;
+}
+
+template <class T>
+bool lf_queue<T>::try_pop(value_type& ret){
+	if(size == 0){
+		return false;
+	}
+
+	std::size_t pos = head.load(std::memory_order_relaxed);
+	slot* cell;
+	while(true){
+		cell = &slots[pos % size];
+		std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+		if(seq == pos + 1){
+			if(head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+				break;
+			}
+		}else if(seq < pos + 1){
+			return false;		//Nothing has been published into this slot yet, so the queue is empty.
+		}else{
+			pos = head.load(std::memory_order_relaxed);
+		}
+	}
+
+	value_type* elem = cell->get();
+	ret = std::move(*elem);
+	elem->~value_type();
+	cell->sequence.store(pos + size, std::memory_order_release);
+	return true;
+}
+
+template <class T>
+bool lf_queue<T>::dequeue(value_type& ret){
+	for(int spins = 0; ; ++spins){
+		if(try_pop(ret)){
+			return true;
+		}
+		if(is_closed.load()){
+			while(!try_pop(ret)){		//Slots claimed just before closing may not be published yet, so wait for those.
+				if(head.load() >= tail.load()){
+					return false;
+				}
+				std::this_thread::yield();
+			}
+			return true;
+		}
+
+		if(spins < spin_limit){
+			std::this_thread::yield();
+		}else{
+			sleepers.fetch_add(1);
+			unsigned seen = pushes.load();
+			if(try_pop(ret)){
+				sleepers.fetch_sub(1);
+				return true;
+			}
+			if(!is_closed.load()){
+				blocking_scope scope;
+				pushes.wait(seen);
+			}
+			sleepers.fetch_sub(1);
+		}
+	}
+}
+
+template <class T>
+void lf_queue<T>::clear(){
+	while(!empty()){
+		std::size_t pos = head.load(std::memory_order_relaxed);
+		slot* cell = &slots[pos % size];
+		if(cell->sequence.load(std::memory_order_acquire) == pos + 1 && head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+			cell->get()->~value_type();
+			cell->sequence.store(pos + size, std::memory_order_release);
+		}
+	}
+}
+
+template <class T>
+void lf_queue<T>::close(){
+	is_closed.store(true);
+	pushes.fetch_add(1);
+	pushes.notify_all();
+}
+
+#endif
\ No newline at end of file
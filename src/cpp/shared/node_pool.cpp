@@ -0,0 +1,149 @@
+#include <new>
+#include <mutex>
+#include <vector>
+#include <utility>
+#include "cpp/shared/node_pool.hpp"
+
+namespace{
+
+constexpr std::size_t class_size = 16;
+constexpr std::size_t max_size = 512;
+constexpr std::size_t classes = max_size / class_size;
+constexpr std::size_t chunk_size = 1 << 16;
+constexpr int batch_size = 64;
+
+struct free_block{
+	free_block* next;
+};
+
+struct free_list{
+	free_block* head = nullptr;
+	int count = 0;
+};
+
+struct shared_lists{
+	std::mutex lock;
+	std::vector<free_list> batches[classes];
+	char* chunk = nullptr;			//Where the next fresh block gets carved from.
+	std::size_t chunk_left = 0;
+};
+
+shared_lists& shared(){
+	static shared_lists* lists = new shared_lists();		//Never destroyed, threads still give blocks back while the program exits.
+	return *lists;
+}
+
+void give_back(std::size_t c, free_list batch){
+	std::unique_lock lk(shared().lock);
+	shared().batches[c].push_back(batch);
+}
+
+free_list take(std::size_t c){
+	shared_lists& s = shared();
+	std::unique_lock lk(s.lock);
+	
+	if(!s.batches[c].empty()){
+		free_list batch = s.batches[c].back();
+		s.batches[c].pop_back();
+		return batch;
+	}
+	
+	std::size_t block = (c + 1) * class_size;
+	free_list batch;
+	for(int i = 0; i < batch_size; ++i){
+		if(s.chunk_left < block){
+			s.chunk = static_cast<char*>(::operator new(chunk_size));		//Whatever was left of the last chunk is too small to matter.
+			s.chunk_left = chunk_size;
+		}
+		free_block* b = reinterpret_cast<free_block*>(s.chunk + s.chunk_left - block);		//Carved from the top down, so the list comes out in address order.
+		s.chunk_left -= block;
+		b->next = batch.head;
+		batch.head = b;
+		++batch.count;
+	}
+	return batch;
+}
+
+/*
+ * The calling thread's free lists.  Once they've been destroyed (epoch_retire() can still free nodes later on in the thread's exit),
+ * blocks go straight to the shared lists instead.
+ */
+struct local_lists{
+	free_list lists[classes];
+	
+	~local_lists();
+};
+
+thread_local bool local_gone = false;
+thread_local local_lists local;
+
+local_lists::~local_lists(){
+	local_gone = true;
+	for(std::size_t c = 0; c < classes; ++c){
+		if(lists[c].count > 0){
+			give_back(c, lists[c]);
+		}
+	}
+}
+
+}
+
+
+
+//----------Pool Functions----------
+
+void* pool_allocate(std::size_t size){
+	if(size > max_size){
+		return ::operator new(size);
+	}
+	
+	std::size_t c = size == 0 ? 0 : (size - 1) / class_size;
+	if(local_gone){
+		free_list batch = take(c);
+		free_block* b = batch.head;
+		batch.head = b->next;
+		--batch.count;
+		if(batch.count > 0){
+			give_back(c, batch);
+		}
+		return b;
+	}
+	
+	free_list& list = local.lists[c];
+	if(list.head == nullptr){
+		list = take(c);
+	}
+	free_block* b = list.head;
+	list.head = b->next;
+	--list.count;
+	return b;
+}
+
+void pool_release(void* p, std::size_t size){
+	if(size > max_size){
+		::operator delete(p);
+		return;
+	}
+	
+	std::size_t c = size == 0 ? 0 : (size - 1) / class_size;
+	free_block* b = static_cast<free_block*>(p);
+	if(local_gone){
+		b->next = nullptr;
+		give_back(c, {b, 1});
+		return;
+	}
+	
+	free_list& list = local.lists[c];
+	b->next = list.head;
+	list.head = b;
+	if(++list.count >= 2 * batch_size){
+		free_block* last = list.head;		//The most recently freed half stays here, since it's the most likely to still be in cache.
+		for(int i = 1; i < batch_size; ++i){
+			last = last->next;
+		}
+		free_list batch{last->next, list.count - batch_size};
+		last->next = nullptr;
+		list.count = batch_size;
+		give_back(c, batch);
+	}
+}
\ No newline at end of file
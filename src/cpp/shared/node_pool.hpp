@@ -0,0 +1,18 @@
+#ifndef NODE_POOL_H_INCLUDED
+#define NODE_POOL_H_INCLUDED
+
+#include <cstddef>
+
+/*
+ * A process-wide allocator for the small nodes of linked containers, in size classes of 16 bytes up to 512.
+ * Blocks are carved out of large chunks in order, so nodes allocated together sit together, and freed blocks get reused first.
+ * Every thread keeps its own free list per size class, and only trades whole batches of blocks with the shared lists
+ * (under a lock) when it runs dry or collects too many.  Chunks are never given back, so blocks stay valid to free even after
+ * the container that allocated them is gone, which is what epoch_retire() needs.
+ */
+
+//Pool Functions.  Bigger sizes just go to operator new.  A block has to be released with the size it was allocated with.
+void* pool_allocate(std::size_t size);
+void pool_release(void* p, std::size_t size);
+
+#endif
\ No newline at end of file
@@ -1,15 +1,118 @@
+#include <map>
 #include <string>
 #include <sstream>
+#include <climits>
+#include <cstring>
 #include <iostream>
+#include <stdexcept>
 #include "parse.hpp"
 
-int scan_int(){
+namespace{
+
+std::map<std::string, long long>& options(){
+	static std::map<std::string, long long> given;
+	return given;
+}
+
+std::ostream* prompts = &std::cout;
+
+long long parse_value(const std::string& name, const std::string& text){
+	long long value;
+	std::stringstream in_stream(text);
+	if(!(in_stream >> value) || !(in_stream >> std::ws).eof()){
+		throw std::invalid_argument("Read a non-integer value for --" + name + ".");
+	}
+	return value;
+}
+
+std::string not_an_integer(const char* name){
+	return name != NULL ? std::string("Read a non-integer value for --") + name + " from std::cin." : "Read a non-integer value from std::cin.";
+}
+
+}
+
+int scan_int(const char* name){
 	int value;
 	std::string read_line;
 	std::getline(std::cin, read_line);
 	std::stringstream in_stream(read_line);
 	if(!(in_stream >> value)){
-		throw std::invalid_argument("Read a non-integer value from std::cin.");
+		throw std::invalid_argument(not_an_integer(name));
 	}
 	return value;
+}
+
+long long scan_long(const char* name){
+	long long value;
+	std::string read_line;
+	std::getline(std::cin, read_line);
+	std::stringstream in_stream(read_line);
+	if(!(in_stream >> value)){
+		throw std::invalid_argument(not_an_integer(name));
+	}
+	return value;
+}
+
+void parse_args(int argc, char* argv[], std::initializer_list<const char*> names){
+	for(int i = 1; i < argc; ++i){
+		std::string arg = argv[i];
+		if(arg.compare(0, 2, "--") != 0){
+			throw std::invalid_argument("Read an argument which isn't a --name=value option: " + arg);
+		}
+		
+		std::string name = arg.substr(2);
+		std::string text;
+		std::size_t equals = name.find('=');
+		if(equals != std::string::npos){
+			text = name.substr(equals + 1);
+			name.erase(equals);
+		}else if(i + 1 < argc){
+			text = argv[++i];
+		}else{
+			throw std::invalid_argument("Read --" + name + " without a value.");
+		}
+		
+		bool known = name == "seed" || name == "repeat";
+		for(auto n = names.begin(); n != names.end(); ++n){
+			known = known || name == *n;
+		}
+		if(!known){
+			throw std::invalid_argument("Read an unknown option, --" + name + ".");
+		}
+		options()[name] = parse_value(name, text);
+	}
+}
+
+void prompt_to(std::ostream& out){
+	prompts = &out;
+}
+
+bool has_arg(const char* name){
+	return options().count(name) != 0;
+}
+
+int arg_int(const char* name, const char* prompt){
+	auto found = options().find(name);
+	if(found == options().end()){
+		*prompts << prompt;
+		return scan_int(name);
+	}
+	if(found->second < INT_MIN || found->second > INT_MAX){
+		throw std::invalid_argument(std::string("Read a value out of range for --") + name + ".");
+	}
+	return found->second;
+}
+
+long long arg_long(const char* name, const char* prompt){
+	auto found = options().find(name);
+	if(found == options().end()){
+		*prompts << prompt;
+		return scan_long(name);
+	}
+	return found->second;
+}
+
+long long arg_or(const char* name, long long fallback){
+	auto found = options().find(name);
+	return found == options().end() ? fallback : found->second;
 }
\ No newline at end of file
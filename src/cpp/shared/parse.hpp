@@ -1,6 +1,24 @@
 #ifndef PARSE_H_INCLUDED
 #define PARSE_H_INCLUDED
 
-int scan_int();
+#include <iosfwd>
+#include <cstddef>
+#include <initializer_list>
+
+int scan_int(const char* name = NULL);			//Names the option being read in its error message, if given.
+long long scan_long(const char* name = NULL);
+
+/*
+ * Command-line options, given as --name=value or --name value, so runs can be scripted instead of answering prompts.
+ * parse_args only accepts the given names, plus --seed and --repeat which every binary takes, and throws std::invalid_argument otherwise.
+ * The arg_ functions return an option if it was given, and otherwise print the prompt and fall back to scan_int/scan_long.
+ * Prompts go to std::cout unless prompt_to says otherwise (e.g. when stdout carries binary output).
+ */
+void parse_args(int argc, char* argv[], std::initializer_list<const char*> names);
+void prompt_to(std::ostream& out);
+bool has_arg(const char* name);
+int arg_int(const char* name, const char* prompt);
+long long arg_long(const char* name, const char* prompt);
+long long arg_or(const char* name, long long fallback);		//Never asks.
 
 #endif
\ No newline at end of file
@@ -0,0 +1,14 @@
+#ifndef PRIME_COUNT_H_INCLUDED
+#define PRIME_COUNT_H_INCLUDED
+
+#include <cstdint>
+
+/*
+ * Counts the primes up to x without listing them, with the Lagarias-Miller-Odlyzko method: pi(x) = phi(x, a) + a - 1 - P2(x, a),
+ * where a = pi(y) for some y a little over x^(1/3).  The leaves of phi's recursion are split into ordinary ones (summed directly)
+ * and special ones, which are all below x / y and get counted by one pass of a segmented sieve over [1, x / y] with a Fenwick tree.
+ * P2 takes another counting pass of the segmented sieve over the same range.  That's about x^(2/3) work, and memory for y and one segment.
+ */
+std::uint64_t prime_pi(std::uint64_t x);		//Up to segmented_sieve::max_value.
+
+#endif
\ No newline at end of file
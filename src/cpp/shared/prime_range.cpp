@@ -0,0 +1,39 @@
+#include "cpp/shared/prime_range.hpp"
+
+
+
+//----------Constructor----------
+
+prime_range::prime_range(std::uint64_t lo, std::uint64_t hi, segmented_sieve::base_list base) : sieve(lo, hi, base), found(), position(0), started(false), finished(false) {}
+
+
+
+//----------Range Functions----------
+
+prime_range::iterator prime_range::begin(){
+	if(!started){
+		started = true;
+		position = found.size();
+		advance();
+	}
+	return iterator(this);
+}
+
+void prime_range::advance(){
+	if(++position < found.size()){
+		return;
+	}
+	
+	while(!finished){
+		found.clear();
+		position = 0;
+		if(!sieve.next_segment()){
+			finished = true;
+		}else{
+			sieve.for_each_prime([this](std::uint64_t p){found.push_back(p);});
+			if(!found.empty()){
+				return;
+			}
+		}
+	}
+}
\ No newline at end of file
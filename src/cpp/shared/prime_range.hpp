@@ -0,0 +1,76 @@
+#ifndef PRIME_RANGE_H_INCLUDED
+#define PRIME_RANGE_H_INCLUDED
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include "cpp/shared/segmented_sieve.hpp"
+
+/*
+ * A lazy range over every prime in [lo, hi], in increasing order, for use in a range-based for loop.
+ * Nothing is sieved until the first prime is asked for, and then only one segment at a time, so the first primes are out right away
+ * and memory stays at the base primes (O(sqrt(hi))) plus a segment and its primes however far apart lo and hi are.
+ * It's a single-pass (input) range: every iterator walks the same sieve, and begin() picks up wherever the last one left off.
+ */
+class prime_range{
+public:
+	
+	class iterator{
+	public:
+		
+		using iterator_category = std::input_iterator_tag;
+		using value_type = std::uint64_t;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const std::uint64_t*;
+		using reference = const std::uint64_t&;
+		
+		iterator() : range(NULL) {}		//The end of any range.
+		
+		reference operator*() const {return range->found[range->position];}
+		pointer operator->() const {return &range->found[range->position];}
+		iterator& operator++() {range->advance(); return *this;}
+		iterator operator++(int) {iterator old = *this; range->advance(); return old;}
+		
+		bool operator==(const iterator& other) const {return done() == other.done();}
+		bool operator!=(const iterator& other) const {return done() != other.done();}
+	
+	private:
+		
+		friend class prime_range;
+		
+		explicit iterator(prime_range* r) : range(r) {}
+		
+		bool done() const {return range == NULL || range->finished;}
+		
+		prime_range* range;
+	
+	};
+	
+	//Constructors/Destructor.
+	prime_range(std::uint64_t lo, std::uint64_t hi, segmented_sieve::base_list base = nullptr);
+	prime_range(const prime_range&) = delete;
+	prime_range(prime_range&&) = delete;
+	~prime_range() = default;
+	
+	//Assignment Operators.
+	prime_range& operator=(const prime_range&) = delete;
+	prime_range& operator=(prime_range&&) = delete;
+	
+	//Range Operations.
+	iterator begin();
+	iterator end() {return iterator();}
+
+private:
+	
+	void advance();		//Moves on to the next prime, sieving segments until one turns up or the range runs out.
+	
+	segmented_sieve sieve;
+	std::vector<std::uint64_t> found;		//The primes in the current segment.
+	std::size_t position;
+	bool started;
+	bool finished;
+
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cpp/shared/prime_table.hpp"
+#include "cpp/shared/segmented_sieve.hpp"
+
+namespace{
+
+std::runtime_error file_error(const std::string& what, const std::string& path){
+	return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+}
+
+
+
+//----------Constructor/Destructor----------
+
+prime_table::prime_table(const std::string& p, std::uint64_t hi) : path(p), mapping(NULL), mapping_size(0), bits(NULL), ranks(NULL), words(0), covered(0) {
+	map();
+	extend(hi);
+}
+
+prime_table::~prime_table(){
+	unmap();
+}
+
+
+
+//----------Table Functions----------
+
+void prime_table::extend(std::uint64_t hi){
+	if(mapping != NULL && hi <= covered){
+		return;
+	}
+	if(hi > segmented_sieve::max_value - block_span){
+		throw std::invalid_argument("The prime table only goes up to 2^62.");
+	}
+	build(hi);
+	unmap();
+	map();
+}
+
+void prime_table::map(){
+	int fd = open(path.c_str(), O_RDONLY);
+	if(fd < 0){
+		if(errno == ENOENT){
+			return;		//Nothing yet, extend() builds it from scratch.
+		}
+		throw file_error("Couldn't open", path);
+	}
+	
+	struct stat st;
+	void* m = MAP_FAILED;
+	if(fstat(fd, &st) == 0 && std::size_t(st.st_size) >= sizeof(header)){
+		m = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+	if(m == MAP_FAILED){
+		return;		//Unreadable or truncated, so it's rebuilt like a missing one.
+	}
+	
+	const header* h = static_cast<const header*>(m);
+	std::size_t expected = sizeof(header) + (h->words + h->blocks + 1) * sizeof(std::uint64_t);
+	if(std::memcmp(h->magic, file_magic, sizeof(file_magic)) != 0 || h->words != h->blocks * block_words || h->limit + 1 != h->words * 128 || expected != std::size_t(st.st_size)){
+		munmap(m, st.st_size);
+		return;
+	}
+	
+	mapping = m;
+	mapping_size = st.st_size;
+	words = h->words;
+	covered = h->limit;
+	bits = reinterpret_cast<const std::uint64_t*>(h + 1);
+	ranks = bits + words;
+}
+
+void prime_table::unmap(){
+	if(mapping != NULL){
+		munmap(mapping, mapping_size);
+	}
+	mapping = NULL;
+	mapping_size = 0;
+	bits = NULL;
+	ranks = NULL;
+	words = 0;
+	covered = 0;
+}
+
+void prime_table::build(std::uint64_t hi){
+	std::uint64_t blocks = hi / block_span + 1;
+	std::uint64_t total_words = blocks * block_words;
+	std::size_t size = sizeof(header) + (total_words + blocks + 1) * sizeof(std::uint64_t);
+	
+	std::string temporary = path + ".tmp." + std::to_string(getpid());		//Renamed over path once it's complete, so readers never see half a table.
+	int fd = open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0){
+		throw file_error("Couldn't create", temporary);
+	}
+	void* m = MAP_FAILED;
+	if(ftruncate(fd, size) == 0){
+		m = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+	if(m == MAP_FAILED){
+		unlink(temporary.c_str());
+		throw file_error("Couldn't size or map", temporary);
+	}
+	
+	header* h = static_cast<header*>(m);
+	std::uint64_t* out_bits = reinterpret_cast<std::uint64_t*>(h + 1);
+	std::uint64_t* out_ranks = out_bits + total_words;
+	
+	std::uint64_t start = 0;		//Everything below this comes from the old table.
+	if(mapping != NULL){
+		std::copy(bits, bits + words, out_bits);
+		start = covered + 1;
+	}
+	segmented_sieve s(start, blocks * block_span - 1);
+	while(s.next_segment()){
+		s.for_each_prime([out_bits](std::uint64_t p){
+			if(p != 2){
+				out_bits[p / 128] |= std::uint64_t(1) << (p / 2 % 64);
+			}
+		});
+	}
+	
+	out_ranks[0] = 0;
+	for(std::uint64_t b = 0; b < blocks; ++b){
+		std::uint64_t count = 0;
+		for(std::uint64_t w = b * block_words; w < (b + 1) * block_words; ++w){
+			count += __builtin_popcountll(out_bits[w]);
+		}
+		out_ranks[b + 1] = out_ranks[b] + count;
+	}
+	
+	std::memcpy(h->magic, file_magic, sizeof(file_magic));
+	h->limit = blocks * block_span - 1;
+	h->words = total_words;
+	h->blocks = blocks;
+	
+	bool synced = msync(m, size, MS_SYNC) == 0;
+	munmap(m, size);
+	if(!synced || rename(temporary.c_str(), path.c_str()) != 0){
+		unlink(temporary.c_str());
+		throw file_error("Couldn't write", path);
+	}
+}
+
+
+
+//----------Query Functions----------
+
+bool prime_table::is_prime(std::uint64_t x) const{
+	if(x > covered){
+		throw std::out_of_range("Asked the prime table about a number past its limit.");
+	}
+	if(x % 2 == 0){
+		return x == 2;
+	}
+	return (bits[x / 128] >> (x / 2 % 64)) & 1;
+}
+
+std::uint64_t prime_table::count_primes(std::uint64_t hi) const{
+	if(hi > covered){
+		throw std::out_of_range("Asked the prime table to count past its limit.");
+	}
+	if(hi < 2){
+		return 0;
+	}
+	
+	std::uint64_t last = (hi - 1) / 2;		//The bit of the largest odd number <= hi.
+	std::uint64_t w = last / 64;
+	std::uint64_t total = 1 + ranks[w / block_words];
+	for(std::uint64_t i = w / block_words * block_words; i < w; ++i){
+		total += __builtin_popcountll(bits[i]);
+	}
+	std::uint64_t tail = last % 64 == 63 ? ~std::uint64_t(0) : (std::uint64_t(1) << (last % 64 + 1)) - 1;
+	return total + __builtin_popcountll(bits[w] & tail);
+}
+
+std::uint64_t prime_table::nth_prime(std::uint64_t k) const{
+	std::uint64_t blocks = words / block_words;
+	if(k == 0 || mapping == NULL || k - 1 > ranks[blocks]){
+		throw std::out_of_range("Asked the prime table for a prime past its limit.");
+	}
+	if(k == 1){
+		return 2;
+	}
+	
+	std::uint64_t remaining = k - 1;		//Which odd prime, counting from one.
+	std::uint64_t b = std::upper_bound(ranks, ranks + blocks + 1, remaining - 1) - ranks - 1;		//The block holding it.
+	remaining -= ranks[b];
+	for(std::uint64_t w = b * block_words; ; ++w){
+		std::uint64_t primes = bits[w];
+		std::uint64_t count = __builtin_popcountll(primes);
+		if(remaining > count){
+			remaining -= count;
+			continue;
+		}
+		for(; remaining > 1; --remaining){
+			primes &= primes - 1;
+		}
+		return 2 * (64 * w + __builtin_ctzll(primes)) + 1;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef PRIME_TABLE_H_INCLUDED
+#define PRIME_TABLE_H_INCLUDED
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+/*
+ * A table of primes kept on disk and memory-mapped, so later runs can answer from it without sieving again.
+ * The file is a 64-byte header, then an odd-only bitmap (bit j is set when 2j + 1 is prime), then a rank index holding how many odd
+ * primes come before each block of block_words words, so counting and selecting only ever scan one block.
+ * Asking for more than the file covers sieves just the missing part (with segmented_sieve) and atomically replaces the file.
+ */
+class prime_table{
+public:
+	
+	static constexpr std::size_t block_words = 64;		//4096 odd numbers, 8192 integers.
+	static constexpr std::uint64_t block_span = block_words * 128;
+	
+	//Constructors/Destructor.
+	prime_table(const std::string& path, std::uint64_t hi);		//Maps the table at path, creating or extending it so it covers [0, hi].
+	prime_table(const prime_table&) = delete;
+	prime_table(prime_table&&) = delete;
+	~prime_table();
+	
+	//Assignment Operators.
+	prime_table& operator=(const prime_table&) = delete;
+	prime_table& operator=(prime_table&&) = delete;
+	
+	//Table Operations.
+	std::uint64_t limit() const {return covered;}		//The largest number the table covers, at least the hi it was opened with.
+	void extend(std::uint64_t hi);						//Makes the table cover [0, hi], if it doesn't already.
+	
+	//Query Operations.  All of them throw std::out_of_range past limit().
+	bool is_prime(std::uint64_t x) const;
+	std::uint64_t count_primes(std::uint64_t hi) const;		//How many primes are <= hi.
+	std::uint64_t nth_prime(std::uint64_t k) const;			//The k-th prime, counting 2 as the first.
+	template <class F>
+	void for_each_prime(std::uint64_t lo, std::uint64_t hi, F f) const;		//Calls f on every prime in [lo, hi], in order.
+
+private:
+	
+	struct header{
+		char magic[8];
+		std::uint64_t limit;
+		std::uint64_t words;
+		std::uint64_t blocks;
+		std::uint64_t padding[4];
+	};
+	
+	static constexpr char file_magic[8] = {'P', 'R', 'I', 'M', 'E', 'T', 'B', '1'};
+	
+	void map();
+	void unmap();
+	void build(std::uint64_t hi);
+	
+	std::string path;
+	void* mapping;
+	std::size_t mapping_size;
+	const std::uint64_t* bits;
+	const std::uint64_t* ranks;
+	std::uint64_t words;
+	std::uint64_t covered;
+
+};
+
+template <class F>
+void prime_table::for_each_prime(std::uint64_t lo, std::uint64_t hi, F f) const{
+	if(hi > covered){
+		is_prime(hi);		//Throws.
+	}
+	if(lo <= 2 && 2 <= hi){
+		f(std::uint64_t(2));
+	}
+	if(hi < 3 || lo > hi){
+		return;
+	}
+	
+	std::uint64_t first = std::max<std::uint64_t>(lo, 3) / 2;		//Bits of the first and last odd numbers in range.
+	std::uint64_t last = (hi - 1) / 2;
+	for(std::uint64_t w = first / 64; w <= last / 64; ++w){
+		std::uint64_t primes = bits[w];
+		if(w == first / 64){
+			primes &= ~std::uint64_t(0) << (first % 64);
+		}
+		if(w == last / 64 && last % 64 != 63){
+			primes &= (std::uint64_t(1) << (last % 64 + 1)) - 1;
+		}
+		while(primes != 0){
+			f(2 * (64 * w + __builtin_ctzll(primes)) + 1);
+			primes &= primes - 1;
+		}
+	}
+}
+
+#endif
\ No newline at end of file
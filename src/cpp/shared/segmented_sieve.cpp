@@ -0,0 +1,227 @@
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <unistd.h>
+#include "cpp/shared/segmented_sieve.hpp"
+
+namespace{
+
+constexpr std::uint64_t wheel_primes[] = {3, 5, 7, 11, 13};
+constexpr std::uint64_t wheel_period = 3 * 5 * 7 * 11 * 13;		//The pattern repeats every this many odd numbers.
+constexpr std::uint32_t first_pattern_prime = 17;
+constexpr std::uint32_t first_sieving_prime = 128;		//Primes below this are ORed in from masks instead.
+
+/*
+ * A prime crossed off with a repeating mask.  Its odd multiples recur every p bits, so word k of the sieve always looks like
+ * sequence[k % p] shifted to the right phase, and the phase is picked by where in the sequence a segment starts.
+ */
+struct pattern_prime{
+	std::uint64_t p;
+	std::uint64_t inverse_64;				//64^-1 mod p.
+	std::vector<std::uint64_t> sequence;	//Word k has bit b set when p divides 64k + b.  p + 8 words long, see or_periodic.
+};
+
+const std::vector<pattern_prime>& pattern_primes(){
+	static const std::vector<pattern_prime> primes = [](){
+		std::vector<pattern_prime> list;
+		for(std::uint64_t p = first_pattern_prime; p < first_sieving_prime; p += 2){
+			bool prime = true;
+			for(std::uint64_t d = 3; d * d <= p; d += 2){
+				prime = prime && p % d != 0;
+			}
+			if(!prime){
+				continue;
+			}
+			
+			pattern_prime pp{p, 1, std::vector<std::uint64_t>(p + 8, 0)};
+			while(pp.inverse_64 * 64 % p != 1){
+				++pp.inverse_64;
+			}
+			for(std::uint64_t bit = 0; bit < 64 * (p + 8); bit += p){
+				pp.sequence[bit / 64] |= std::uint64_t(1) << (bit % 64);
+			}
+			list.push_back(pp);
+		}
+		return list;
+	}();
+	return primes;
+}
+
+/*
+ * The odd multiples of the wheel primes, with bit j standing for 2j + 1.
+ * It's one period plus a whole segment long, so a segment can be copied out of it starting anywhere in the first period.
+ */
+const std::vector<std::uint64_t>& pattern(){
+	static const std::vector<std::uint64_t> bits = [](){
+		std::size_t total = wheel_period + segmented_sieve::segment_bytes() * 8 + 128;
+		std::vector<std::uint64_t> p((total + 63) / 64, 0);
+		for(std::uint64_t w : wheel_primes){
+			for(std::uint64_t j = (w - 1) / 2; j < total; j += w){
+				p[j / 64] |= std::uint64_t(1) << (j % 64);
+			}
+		}
+		return p;
+	}();
+	return bits;
+}
+
+std::uint64_t integer_sqrt(std::uint64_t n){
+	std::uint64_t r = std::sqrt(static_cast<double>(n));
+	while(r * r > n){
+		--r;
+	}
+	while((r + 1) * (r + 1) <= n){
+		++r;
+	}
+	return r;
+}
+
+}
+
+
+
+//----------Constructor----------
+
+segmented_sieve::segmented_sieve(std::uint64_t l, std::uint64_t h, base_list b) : base(b), bits(), next(), lo(l), hi(h), low(0), length(0), next_low(0), started(false), has_two(false) {
+	if(hi > max_value){
+		throw std::invalid_argument("The segmented sieve only goes up to 2^62.");
+	}
+	if(!base){
+		base = base_primes(hi);
+	}
+	
+	next_low = std::max<std::uint64_t>(lo, 3) | 1;
+	for(auto i = base->begin(); i != base->end() && std::uint64_t(*i) * *i <= hi; ++i){
+		std::uint64_t p = *i;
+		if(p < first_sieving_prime){
+			continue;
+		}
+		std::uint64_t m = std::max(p * p, next_low);	//The first odd multiple of p worth crossing off.
+		m = (m + p - 1) / p * p;
+		if(m % 2 == 0){
+			m += p;
+		}
+		next.push_back(m);
+	}
+}
+
+
+
+//----------Sieve Functions----------
+
+bool segmented_sieve::next_segment(){
+	has_two = !started && lo <= 2 && 2 <= hi;
+	started = true;
+	
+	if(next_low > hi){
+		low = next_low;
+		length = 0;
+		bits.clear();
+		return has_two;
+	}
+	
+	low = next_low;
+	length = std::min<std::uint64_t>(segment_bytes() * 8, (hi - low) / 2 + 1);
+	next_low = low + 2 * length;
+	bits.resize((length + 63) / 64);
+	
+	pre_sieve();
+	cross_off();
+	
+	if(length % 64 != 0){
+		bits.back() |= ~std::uint64_t(0) << (length % 64);		//Past hi.
+	}
+	for(std::uint64_t w : wheel_primes){
+		if(low <= w && w < next_low){
+			std::uint64_t i = (w - low) / 2;
+			bits[i / 64] &= ~(std::uint64_t(1) << (i % 64));	//The patterns cross off the small primes themselves too.
+		}
+	}
+	for(auto pp = pattern_primes().begin(); pp != pattern_primes().end(); ++pp){
+		if(low <= pp->p && pp->p < next_low){
+			std::uint64_t i = (pp->p - low) / 2;
+			bits[i / 64] &= ~(std::uint64_t(1) << (i % 64));
+		}
+	}
+	return true;
+}
+
+std::uint64_t segmented_sieve::count_primes() const{
+	return count_clear_bits(bits.data(), bits.size()) + (has_two ? 1 : 0);
+}
+
+void segmented_sieve::pre_sieve(){
+	const std::vector<std::uint64_t>& p = pattern();
+	std::uint64_t offset = ((low - 1) / 2) % wheel_period;
+	std::size_t word = offset / 64;
+	unsigned shift = offset % 64;
+	
+	if(shift == 0){
+		std::copy(p.begin() + word, p.begin() + word + bits.size(), bits.begin());
+	}else{
+		for(std::size_t i = 0; i < bits.size(); ++i){
+			bits[i] = (p[word + i] >> shift) | (p[word + i + 1] << (64 - shift));
+		}
+	}
+}
+
+void segmented_sieve::cross_off(){
+	for(auto pp = pattern_primes().begin(); pp != pattern_primes().end(); ++pp){
+		std::uint64_t p = pp->p;
+		std::uint64_t first = (p - low % p) % p * ((p + 1) / 2) % p;		//Bit of the first odd multiple, since bit i stands for low + 2i.
+		or_periodic(bits.data(), bits.size(), pp->sequence.data(), p, (p - first) % p * pp->inverse_64 % p);
+	}
+	
+	const std::vector<std::uint32_t>& primes = *base;
+	std::size_t k = std::lower_bound(primes.begin(), primes.end(), first_sieving_prime) - primes.begin();
+	std::uint64_t high = low + 2 * (length - 1);
+	
+	for(auto m = next.begin(); m != next.end(); ++m, ++k){
+		std::uint64_t p = primes[k];
+		if(p * p > high){
+			break;		//Neither this prime nor any larger one has anything to cross off yet.
+		}
+		
+		std::uint64_t i = (*m - low) / 2;
+		for(; i < length; i += p){
+			bits[i / 64] |= std::uint64_t(1) << (i % 64);
+		}
+		*m = low + 2 * i;
+	}
+}
+
+
+
+//----------Base Prime Functions----------
+
+segmented_sieve::base_list segmented_sieve::base_primes(std::uint64_t hi){
+	std::uint64_t limit = integer_sqrt(hi);
+	std::vector<std::uint32_t> primes;
+	if(limit >= 2){
+		primes.push_back(2);
+	}
+	
+	std::vector<bool> composite(limit / 2 + 1, false);		//Entry j stands for 2j + 1.
+	for(std::uint64_t j = 1; 2 * j + 1 <= limit; ++j){
+		if(!composite[j]){
+			std::uint64_t p = 2 * j + 1;
+			primes.push_back(p);
+			for(std::uint64_t m = p * p; m <= limit; m += 2 * p){
+				composite[m / 2] = true;
+			}
+		}
+	}
+	return std::make_shared<const std::vector<std::uint32_t>>(std::move(primes));
+}
+
+std::size_t segmented_sieve::segment_bytes(){
+	static const std::size_t bytes = [](){
+		long l1 = -1;
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+		l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+#endif
+		std::size_t b = l1 > 0 ? l1 : 32 * 1024;
+		return std::clamp<std::size_t>(b, 16 * 1024, 1024 * 1024) / 8 * 8;
+	}();
+	return bytes;
+}
\ No newline at end of file
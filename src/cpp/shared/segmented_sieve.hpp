@@ -0,0 +1,153 @@
+#ifndef SEGMENTED_SIEVE_H_INCLUDED
+#define SEGMENTED_SIEVE_H_INCLUDED
+
+#include <memory>
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "cpp/shared/thread_pool.hpp"
+#include "cpp/shared/sieve_kernels.hpp"
+
+/*
+ * A segmented Sieve of Eratosthenes over [lo, hi], one cache-sized segment at a time.
+ * Segments only hold odd numbers, one bit each (set means composite), so a 32KB segment covers 524288 integers.
+ * Every segment starts as a copy of a pre-sieved pattern with the multiples of 3, 5, 7, 11 and 13 already crossed off.
+ * The primes from 17 to 127 are ORed in a vector at a time from per-prime repeating masks, and only the base primes from 131 up to
+ * sqrt(hi) are crossed off one multiple at a time.  Memory use is the segment plus the base primes.
+ * The vector loops live in sieve_kernels.hpp.
+ */
+class segmented_sieve{
+public:
+	
+	using base_list = std::shared_ptr<const std::vector<std::uint32_t>>;
+	
+	static constexpr std::uint64_t max_value = std::uint64_t(1) << 62;
+	
+	//Constructors/Destructor.
+	segmented_sieve(std::uint64_t lo, std::uint64_t hi, base_list base = nullptr);	//Base primes are computed if not given, and can be shared between sieves.
+	segmented_sieve(const segmented_sieve&) = delete;
+	segmented_sieve(segmented_sieve&&) = default;
+	~segmented_sieve() = default;
+	
+	//Assignment Operators.
+	segmented_sieve& operator=(const segmented_sieve&) = delete;
+	segmented_sieve& operator=(segmented_sieve&&) = default;
+	
+	//Sieve Operations.
+	bool next_segment();					//Sieves the next segment.  Returns false once the whole range has been sieved.
+	template <class F>
+	void for_each_prime(F f) const;			//Calls f on every prime in the current segment, in increasing order.
+	std::uint64_t count_primes() const;		//Counts the primes in the current segment.
+	
+	//Base Primes.
+	static base_list base_primes(std::uint64_t hi);		//Every prime up to sqrt(hi).
+	static std::size_t segment_bytes();					//The size of one segment, picked from the L1 data cache size.
+	static std::uint64_t segment_span() {return segment_bytes() * 16;}		//How many integers one segment covers.
+
+private:
+	
+	static constexpr std::size_t extract_words = 64;		//Primes are extracted this many words at a time, into found.
+	
+	void pre_sieve();
+	void cross_off();
+	
+	base_list base;
+	std::vector<std::uint64_t> bits;		//Bit i stands for low + 2i.
+	std::vector<std::uint64_t> next;		//For each base prime from 131 up, its next odd multiple to cross off.
+	mutable std::vector<std::uint64_t> found;
+	std::uint64_t lo;
+	std::uint64_t hi;
+	std::uint64_t low;						//The first (odd) number in the current segment.
+	std::uint64_t length;					//How many odd numbers are in the current segment.
+	std::uint64_t next_low;
+	bool started;
+	bool has_two;							//Whether 2 belongs to the current segment.  It's the only even prime, so no segment holds it.
+
+};
+
+template <class F>
+void segmented_sieve::for_each_prime(F f) const{
+	if(has_two){
+		f(std::uint64_t(2));
+	}
+	found.resize(64 * extract_words);
+	for(std::size_t i = 0; i < bits.size(); i += extract_words){
+		std::size_t words = std::min(extract_words, bits.size() - i);
+		std::size_t total = extract_clear_bits(bits.data() + i, words, low + 128 * i, found.data());
+		for(std::size_t j = 0; j < total; ++j){
+			f(found[j]);
+		}
+	}
+}
+
+/*
+ * Every prime in [lo, hi], in order.  T has to be wide enough for hi.
+ */
+template <class T>
+std::vector<T> segmented_primes(std::uint64_t lo, std::uint64_t hi){
+	std::vector<T> primes;
+	segmented_sieve s(lo, hi);
+	while(s.next_segment()){
+		s.for_each_prime([&](std::uint64_t p){primes.push_back(T(p));});
+	}
+	return primes;
+}
+
+/*
+ * Calls f on every prime in [lo, hi], in increasing order, sieving on the given number of threads (0 for one per core).
+ * The base primes are computed once and shared.  Each thread sieves its own run of whole segments independently, and every wave
+ * of runs is handed to f in order once it's done, so memory stays bounded however large the range is.
+ */
+template <class F>
+void parallel_for_each_prime(std::uint64_t lo, std::uint64_t hi, int threads, F f){
+	if(threads < 1){
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	if(lo > hi){
+		return;
+	}
+	
+	segmented_sieve::base_list base = segmented_sieve::base_primes(hi);
+	std::uint64_t span = segmented_sieve::segment_span();
+	std::uint64_t runs = (hi - lo) / span / threads + 1;		//Segments per thread, if the range were split evenly...
+	std::uint64_t chunk = span * std::min<std::uint64_t>(runs, 64);	//...up to 64, so a wave holds a few million primes at most.
+	
+	thread_pool pool(threads);
+	std::vector<std::vector<std::uint64_t>> found(threads);
+	for(std::uint64_t start = lo; start <= hi;){
+		int used = 0;
+		for(; used < threads && start <= hi; ++used){
+			std::uint64_t end = hi - start < chunk ? hi : start + chunk - 1;
+			std::vector<std::uint64_t>& out = found[used];
+			pool.submit([&base, &out, start, end](){
+				out.clear();
+				segmented_sieve s(start, end, base);
+				while(s.next_segment()){
+					s.for_each_prime([&](std::uint64_t p){out.push_back(p);});
+				}
+			});
+			start = end + 1;
+		}
+		pool.wait_idle();
+		
+		for(int i = 0; i < used; ++i){
+			for(auto p = found[i].begin(); p != found[i].end(); ++p){
+				f(*p);
+			}
+		}
+	}
+}
+
+/*
+ * The same as segmented_primes, sieved on the given number of threads.
+ */
+template <class T>
+std::vector<T> parallel_segmented_primes(std::uint64_t lo, std::uint64_t hi, int threads){
+	std::vector<T> primes;
+	parallel_for_each_prime(lo, hi, threads, [&](std::uint64_t p){primes.push_back(T(p));});
+	return primes;
+}
+
+#endif
\ No newline at end of file
@@ -1,17 +1,143 @@
+#include <bit>
+#include <ctime>
+#include <thread>
+#include <climits>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 #include "cpp/shared/semaphore.hpp"
 
-void semaphore::wait(){
+namespace{
+
+typedef std::chrono::steady_clock futex_clock;		//FUTEX_WAIT times out against CLOCK_MONOTONIC.
+
+static_assert(sizeof(std::atomic<std::uint64_t>) == sizeof(std::uint64_t) && std::atomic<std::uint64_t>::is_always_lock_free,
+	"The futex calls need std::atomic<std::uint64_t> to be a plain pair of ints.");
+
+void futex_wait(int* word, int expected, const std::chrono::nanoseconds* timeout){
+	struct timespec relative;
+	if(timeout != nullptr){
+		relative.tv_sec = timeout->count() / 1000000000;
+		relative.tv_nsec = timeout->count() % 1000000000;
+	}
+	syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, timeout != nullptr ? &relative : nullptr, nullptr, 0);
+}
+
+void futex_wake(int* word, int count){
+	syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+}
+
+
+
+//----------Semaphore Functions----------
+
+void semaphore::wait(int n){
+	acquire(n, nullptr);
+}
+
+bool semaphore::try_wait(){
+	std::uint64_t current = value.load(std::memory_order_relaxed);
+	while((current & permits) >= 1){
+		if(value.compare_exchange_weak(current, current - 1, std::memory_order_acquire, std::memory_order_relaxed)){
+			return true;
+		}
+	}
+	return false;
+}
+
+void semaphore::signal(int n){
+	int* word = count_word();
+	std::uint64_t previous = value.fetch_add(n, std::memory_order_release);
+	
+	//From here on only previous and the word's address get used, since the semaphore may already be gone.
+	int bulk = previous / bulk_sleeper;
+	int asleep = previous / sleeper % (bulk_sleeper / sleeper);
+	if(bulk > 0){
+		futex_wake(word, INT_MAX);
+	}else if(asleep > 0){
+		futex_wake(word, n < asleep ? n : asleep);
+	}
+}
+
+bool semaphore::acquire(int n, const std::chrono::nanoseconds* timeout){
+	futex_clock::time_point deadline;
+	if(timeout != nullptr){
+		deadline = futex_clock::now() + *timeout;
+	}
+	
+	std::uint64_t me = n > 1 ? bulk_sleeper : sleeper;
+	std::uint64_t current = value.load(std::memory_order_relaxed);
+	for(int spins = 0; ; ++spins){
+		if((current & permits) >= std::uint64_t(n)){
+			if(value.compare_exchange_weak(current, current - n, std::memory_order_acquire, std::memory_order_relaxed)){
+				return true;
+			}
+		}else if(spins < spin_limit){
+			std::this_thread::yield();
+			current = value.load(std::memory_order_relaxed);
+		}else{
+			std::chrono::nanoseconds left = std::chrono::nanoseconds::zero();
+			if(timeout != nullptr){
+				left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - futex_clock::now());
+				if(left <= std::chrono::nanoseconds::zero()){
+					return false;
+				}
+			}
+			if(!value.compare_exchange_weak(current, current + me, std::memory_order_relaxed)){
+				continue;		//current is fresh for the next pass.
+			}
+			{
+				blocking_scope scope;
+				futex_wait(count_word(), static_cast<int>(current & permits), timeout != nullptr ? &left : nullptr);		//Only sleeps if the count hasn't changed since we looked.
+			}
+			current = value.fetch_sub(me, std::memory_order_relaxed) - me;
+		}
+	}
+}
+
+int* semaphore::count_word(){
+	return reinterpret_cast<int*>(&value) + (std::endian::native == std::endian::little ? 0 : 1);
+}
+
+
+
+//----------Locking Semaphore Functions----------
+
+void locking_semaphore::wait(int n){
+	std::unique_lock lk(lock);
+	
+	if(value < n){
+		if(n > 1){
+			++bulk_waiters;
+		}
+		blocking_scope scope;
+		waiter.wait(lk, [=, this](){return value >= n;});
+		if(n > 1){
+			--bulk_waiters;
+		}
+	}
+	value -= n;
+}
+
+bool locking_semaphore::try_wait(){
 	std::unique_lock lk(lock);
 	
 	if(value == 0){
-		waiter.wait(lk, [=](){return value > 0;});
+		return false;
 	}
 	--value;
+	return true;
 }
 
-void semaphore::signal(){
+void locking_semaphore::signal(int n){
 	std::unique_lock lk(lock);
 	
-	++value;
-	waiter.notify_one();
+	value += n;
+	if(n > 1 || bulk_waiters > 0){
+		waiter.notify_all();
+	}else{
+		waiter.notify_one();
+	}
 }
\ No newline at end of file
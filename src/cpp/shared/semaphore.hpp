@@ -2,13 +2,25 @@
 #define SEMAPHORE_H_INCLUDED
 
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <condition_variable>
+#include "cpp/shared/thread_pool.hpp"
 
+/*
+ * The default semaphore.  Its count lives in an atomic, so uncontended waits and signals never take a lock.
+ * Threads which actually have to sleep wait on the count itself with a futex, and count themselves as asleep in the same word,
+ * so a signal is one atomic update followed (only if somebody is asleep) by waking as many sleepers as it has permits for,
+ * which needs nothing but the word's address.
+ * That matters because whoever signals last can't touch the semaphore after its update: a waiter may already have taken the
+ * permit and destroyed it (e.g. a semaphore on the waiter's stack).
+ */
 class semaphore{
 public:
 	
 	//Constructors/Destructor.
-	semaphore(int i = 0) : lock(), waiter(), value(i >= 0 ? i : 0) {}
+	semaphore(int i = 0) : value(i >= 0 ? i : 0) {}
 	semaphore(const semaphore&) = delete;
 	semaphore(semaphore&&) = delete;
 	~semaphore() = default;
@@ -17,16 +29,108 @@ public:
 	semaphore& operator=(const semaphore&) = delete;
 	semaphore& operator=(semaphore&&) = delete;
 	
-	//Semaphore Operations.
-	void wait();
-	void signal();
+	//Semaphore Operations.  The counted versions acquire/release n permits at once.
+	void wait(int n = 1);
+	void signal(int n = 1);
+	
+	//Non-blocking and Timed Operations.  These return whether or not the semaphore was acquired.
+	bool try_wait();
+	template <class Rep, class Period>
+	bool wait_for(const std::chrono::duration<Rep, Period>&);
+	template <class Clock, class Duration>
+	bool wait_until(const std::chrono::time_point<Clock, Duration>&);
+
+private:
+	
+	static constexpr int spin_limit = 32;
+	
+	//value packs three counts into one word: the permits in the low 32 bits (which double as the futex word), then how many
+	//single waiters are (about to be) asleep, then how many counted ones.  Waking just one sleeper might not free anyone
+	//while counted waiters are asleep, so signals wake everybody then.
+	static constexpr std::uint64_t permits = 0xffffffff;
+	static constexpr std::uint64_t sleeper = std::uint64_t(1) << 32;
+	static constexpr std::uint64_t bulk_sleeper = std::uint64_t(1) << 48;
+	
+	bool acquire(int n, const std::chrono::nanoseconds* timeout);		//Sleeps for at most *timeout if it isn't null, and returns whether the permits were taken.
+	int* count_word();		//The half of value holding the permits.
+	
+	std::atomic<std::uint64_t> value;
+
+};
+
+/*
+ * The original semaphore, built from a mutex and a condition variable.
+ * Kept around as a baseline to benchmark the atomic one against.
+ */
+class locking_semaphore{
+public:
+	
+	//Constructors/Destructor.
+	locking_semaphore(int i = 0) : lock(), waiter(), value(i >= 0 ? i : 0), bulk_waiters(0) {}
+	locking_semaphore(const locking_semaphore&) = delete;
+	locking_semaphore(locking_semaphore&&) = delete;
+	~locking_semaphore() = default;
+	
+	//Assignment Operators.
+	locking_semaphore& operator=(const locking_semaphore&) = delete;
+	locking_semaphore& operator=(locking_semaphore&&) = delete;
+	
+	//Semaphore Operations.  The counted versions acquire/release n permits at once.
+	void wait(int n = 1);
+	void signal(int n = 1);
+	
+	//Non-blocking and Timed Operations.  These return whether or not the semaphore was acquired.
+	bool try_wait();
+	template <class Rep, class Period>
+	bool wait_for(const std::chrono::duration<Rep, Period>&);
+	template <class Clock, class Duration>
+	bool wait_until(const std::chrono::time_point<Clock, Duration>&);
 
 private:
 	
 	mutable std::mutex lock;
 	mutable std::condition_variable waiter;
 	int value;
+	int bulk_waiters;
 
 };
 
+template <class Rep, class Period>
+bool semaphore::wait_for(const std::chrono::duration<Rep, Period>& timeout){
+	return wait_until(std::chrono::steady_clock::now() + timeout);
+}
+
+template <class Clock, class Duration>
+bool semaphore::wait_until(const std::chrono::time_point<Clock, Duration>& deadline){
+	//Sleeps on the count for what's left according to Clock, which needn't tick along with the steady clock the futex times against.
+	while(true){
+		std::chrono::nanoseconds left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - Clock::now());
+		if(left <= std::chrono::nanoseconds::zero()){
+			return try_wait();
+		}
+		if(acquire(1, &left)){
+			return true;
+		}
+	}
+}
+
+template <class Rep, class Period>
+bool locking_semaphore::wait_for(const std::chrono::duration<Rep, Period>& timeout){
+	return wait_until(std::chrono::steady_clock::now() + timeout);
+}
+
+template <class Clock, class Duration>
+bool locking_semaphore::wait_until(const std::chrono::time_point<Clock, Duration>& deadline){
+	std::unique_lock lk(lock);
+	
+	if(value == 0){
+		blocking_scope scope;
+		if(!waiter.wait_until(lk, deadline, [this](){return value > 0;})){
+			return false;
+		}
+	}
+	--value;
+	return true;
+}
+
 #endif
\ No newline at end of file
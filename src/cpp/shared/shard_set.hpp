@@ -0,0 +1,208 @@
+#ifndef SHARD_SET_H_INCLUDED
+#define SHARD_SET_H_INCLUDED
+
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+
+/*
+ * This object represents a concurrent hash set, split by hash into independently locked shards.
+ * Each shard is an open-addressed table kept in flat arrays (linear probing, with tombstones for removed elements).
+ * Searches share their shard's lock and writers take it alone, so operations on different shards never wait for each other.
+ * A shard that fills up rehashes itself under its own lock, so resizing only ever stalls the keys in that one shard.
+ */
+template <class T, class Hash = std::hash<T>>
+class shard_set {
+public:
+	
+	using value_type = T;
+	
+	static constexpr std::size_t default_shards = 64;
+	
+	//Constructors/Destructor
+	shard_set(std::size_t n = default_shards);		//Rounded up to a power of two, and at least two.
+	shard_set(const shard_set&) = delete;
+	shard_set(shard_set&&) = delete;
+	~shard_set() = default;
+	
+	//Assignment Operators
+	shard_set& operator=(const shard_set&) = delete;
+	shard_set& operator=(shard_set&&) = delete;
+	
+	//Set Operations
+	bool contains(const value_type&) const;		//Returns whether or not the element is in the set.
+	bool insert(const value_type&);				//Adds the element.  Fails if it's already there.
+	bool remove(const value_type&);				//Removes the element.  Fails if it isn't there.
+	std::size_t size() const;					//Only a snapshot while other threads are active.
+
+private:
+	
+	static constexpr std::size_t min_capacity = 16;
+	
+	enum slot_state : std::uint8_t {empty, full, removed};
+	
+	struct alignas(64) shard{
+		mutable std::shared_mutex lock;
+		std::vector<value_type> values;
+		std::vector<std::uint8_t> states;
+		std::size_t count = 0;			//Full slots.
+		std::size_t used = 0;			//Full or removed slots, which is what makes probes long.
+	};
+	
+	//std::hash is the identity for integers, so the bits get mixed (the splitmix64 finalizer) before picking a shard and a slot.
+	static std::uint64_t mix(std::uint64_t h);
+	
+	shard& shard_for(std::uint64_t h) const {return shards[h >> shift];}
+	static std::size_t probe(const shard&, const value_type&, std::uint64_t h, std::size_t& free_slot);		//Where the element is, or the first empty slot if it isn't there.
+	void rehash(shard&) const;
+	
+	mutable std::vector<shard> shards;
+	int shift;		//The top bits of a hash pick the shard, and the low bits the slot, so the two stay independent.
+	Hash hasher;
+
+};
+
+template <class T, class Hash>
+shard_set<T, Hash>::shard_set(std::size_t n) : shards(), shift(64), hasher() {
+	std::size_t count = 2;
+	--shift;
+	while(count < n){
+		count *= 2;
+		--shift;
+	}
+	shards = std::vector<shard>(count);
+	for(auto s = shards.begin(); s != shards.end(); ++s){
+		s->values.resize(min_capacity);
+		s->states.assign(min_capacity, empty);
+	}
+}
+
+template <class T, class Hash>
+std::uint64_t shard_set<T, Hash>::mix(std::uint64_t h){
+	h ^= h >> 30;
+	h *= 0xbf58476d1ce4e5b9ULL;
+	h ^= h >> 27;
+	h *= 0x94d049bb133111ebULL;
+	h ^= h >> 31;
+	return h;
+}
+
+template <class T, class Hash>
+std::size_t shard_set<T, Hash>::probe(const shard& s, const value_type& x, std::uint64_t h, std::size_t& free_slot){
+	std::size_t mask = s.states.size() - 1;
+	free_slot = s.states.size();
+	for(std::size_t i = h & mask; ; i = (i + 1) & mask){
+		if(s.states[i] == empty){
+			if(free_slot == s.states.size()){
+				free_slot = i;
+			}
+			return i;
+		}
+		if(s.states[i] == removed){
+			if(free_slot == s.states.size()){
+				free_slot = i;
+			}
+		}else if(s.values[i] == x){
+			return i;
+		}
+	}
+}
+
+template <class T, class Hash>
+void shard_set<T, Hash>::rehash(shard& s) const{
+	std::size_t capacity = min_capacity;
+	while(capacity < s.count * 2 + 2){
+		capacity *= 2;
+	}
+	
+	std::vector<value_type> old_values(capacity);
+	std::vector<std::uint8_t> old_states(capacity, empty);
+	old_values.swap(s.values);
+	old_states.swap(s.states);
+	s.used = s.count;
+	
+	std::size_t mask = capacity - 1;
+	for(std::size_t i = 0; i < old_states.size(); ++i){
+		if(old_states[i] == full){
+			std::size_t j = mix(hasher(old_values[i])) & mask;
+			while(s.states[j] != empty){
+				j = (j + 1) & mask;
+			}
+			s.values[j] = std::move(old_values[i]);
+			s.states[j] = full;
+		}
+	}
+}
+
+template <class T, class Hash>
+bool shard_set<T, Hash>::contains(const value_type& x) const{
+	std::uint64_t h = mix(hasher(x));
+	shard& s = shard_for(h);
+	std::shared_lock lk(s.lock);
+	
+	std::size_t free_slot;
+	std::size_t i = probe(s, x, h, free_slot);
+	return s.states[i] == full;
+}
+
+template <class T, class Hash>
+bool shard_set<T, Hash>::insert(const value_type& x){
+	std::uint64_t h = mix(hasher(x));
+	shard& s = shard_for(h);
+	std::unique_lock lk(s.lock);
+	
+	std::size_t free_slot;
+	std::size_t i = probe(s, x, h, free_slot);
+	if(s.states[i] == full){
+		return false;
+	}
+	
+	if(s.states[free_slot] == empty){
+		if((s.used + 1) * 4 > s.states.size() * 3){		//Keeps at least a quarter of the slots empty, so probes stay short and always end.
+			rehash(s);
+			probe(s, x, h, free_slot);
+		}
+		++s.used;
+	}
+	s.values[free_slot] = x;
+	s.states[free_slot] = full;
+	++s.count;
+	return true;
+}
+
+template <class T, class Hash>
+bool shard_set<T, Hash>::remove(const value_type& x){
+	std::uint64_t h = mix(hasher(x));
+	shard& s = shard_for(h);
+	std::unique_lock lk(s.lock);
+	
+	std::size_t free_slot;
+	std::size_t i = probe(s, x, h, free_slot);
+	if(s.states[i] != full){
+		return false;
+	}
+	
+	if(s.states[(i + 1) & (s.states.size() - 1)] == empty){
+		s.states[i] = empty;		//No probe runs past this slot, so it doesn't need a tombstone.
+		--s.used;
+	}else{
+		s.states[i] = removed;
+	}
+	--s.count;
+	return true;
+}
+
+template <class T, class Hash>
+std::size_t shard_set<T, Hash>::size() const{
+	std::size_t total = 0;
+	for(auto s = shards.begin(); s != shards.end(); ++s){
+		std::shared_lock lk(s->lock);
+		total += s->count;
+	}
+	return total;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include <cstdlib>
+#include <cstring>
+#include <immintrin.h>
+#include "cpp/shared/sieve_kernels.hpp"
+
+namespace{
+
+typedef void (*or_periodic_kernel)(std::uint64_t*, std::size_t, const std::uint64_t*, std::size_t, std::size_t);
+typedef std::size_t (*extract_kernel)(const std::uint64_t*, std::size_t, std::uint64_t, std::uint64_t*);
+typedef std::uint64_t (*count_kernel)(const std::uint64_t*, std::size_t);
+
+struct kernel_set{
+	const char* name;
+	or_periodic_kernel or_periodic;
+	extract_kernel extract;
+	count_kernel count;
+};
+
+
+
+//----------Scalar Kernels----------
+
+void or_periodic_scalar(std::uint64_t* words, std::size_t n, const std::uint64_t* sequence, std::size_t period, std::size_t start){
+	for(std::size_t i = 0; i < n; ++i){
+		words[i] |= sequence[start];
+		if(++start == period){
+			start = 0;
+		}
+	}
+}
+
+std::size_t extract_scalar(const std::uint64_t* words, std::size_t n, std::uint64_t low, std::uint64_t* out){
+	std::size_t count = 0;
+	for(std::size_t i = 0; i < n; ++i){
+		std::uint64_t clear = ~words[i];
+		std::uint64_t base = low + 128 * i;
+		while(clear != 0){
+			out[count++] = base + 2 * __builtin_ctzll(clear);
+			clear &= clear - 1;
+		}
+	}
+	return count;
+}
+
+std::uint64_t count_scalar(const std::uint64_t* words, std::size_t n){
+	std::uint64_t total = 0;
+	for(std::size_t i = 0; i < n; ++i){
+		total += __builtin_popcountll(~words[i]);
+	}
+	return total;
+}
+
+
+
+//----------AVX2 Kernels----------
+
+__attribute__((target("avx2")))
+void or_periodic_avx2(std::uint64_t* words, std::size_t n, const std::uint64_t* sequence, std::size_t period, std::size_t start){
+	std::size_t i = 0;
+	for(; i + 4 <= n; i += 4){
+		__m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+		__m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sequence + start));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(words + i), _mm256_or_si256(w, s));
+		start += 4;
+		if(start >= period){
+			start -= period;
+		}
+	}
+	or_periodic_scalar(words + i, n - i, sequence, period, start);
+}
+
+__attribute__((target("avx2,bmi")))
+std::size_t extract_avx2(const std::uint64_t* words, std::size_t n, std::uint64_t low, std::uint64_t* out){
+	const __m256i ones = _mm256_set1_epi64x(-1);
+	std::size_t count = 0;
+	std::size_t i = 0;
+	for(; i + 4 <= n; i += 4){
+		__m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+		if(_mm256_testc_si256(w, ones)){
+			continue;		//Four words of nothing but composites.
+		}
+		for(std::size_t j = i; j < i + 4; ++j){
+			std::uint64_t clear = ~words[j];
+			std::uint64_t base = low + 128 * j;
+			while(clear != 0){
+				out[count++] = base + 2 * _tzcnt_u64(clear);
+				clear = _blsr_u64(clear);
+			}
+		}
+	}
+	return count + extract_scalar(words + i, n - i, low + 128 * i, out + count);
+}
+
+__attribute__((target("avx2,popcnt")))
+std::uint64_t count_avx2(const std::uint64_t* words, std::size_t n){
+	const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i nibble = _mm256_set1_epi8(0x0f);
+	const __m256i ones = _mm256_set1_epi64x(-1);
+	__m256i totals = _mm256_setzero_si256();
+	
+	std::size_t i = 0;
+	for(; i + 4 <= n; i += 4){
+		__m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i)), ones);
+		__m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, nibble));
+		__m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+		totals = _mm256_add_epi64(totals, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+	}
+	
+	std::uint64_t total = _mm256_extract_epi64(totals, 0) + _mm256_extract_epi64(totals, 1) + _mm256_extract_epi64(totals, 2) + _mm256_extract_epi64(totals, 3);
+	for(; i < n; ++i){
+		total += _mm_popcnt_u64(~words[i]);
+	}
+	return total;
+}
+
+
+
+//----------AVX-512 Kernels----------
+
+__attribute__((target("avx512f")))
+void or_periodic_avx512(std::uint64_t* words, std::size_t n, const std::uint64_t* sequence, std::size_t period, std::size_t start){
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8){
+		__m512i w = _mm512_loadu_si512(words + i);
+		__m512i s = _mm512_loadu_si512(sequence + start);
+		_mm512_storeu_si512(words + i, _mm512_or_si512(w, s));
+		start += 8;
+		if(start >= period){
+			start -= period;
+		}
+	}
+	or_periodic_scalar(words + i, n - i, sequence, period, start);
+}
+
+__attribute__((target("avx512f,bmi")))
+std::size_t extract_avx512(const std::uint64_t* words, std::size_t n, std::uint64_t low, std::uint64_t* out){
+	const __m512i ones = _mm512_set1_epi64(-1);
+	std::size_t count = 0;
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8){
+		unsigned live = _mm512_cmpneq_epi64_mask(_mm512_loadu_si512(words + i), ones);		//Words with at least one prime.
+		while(live != 0){
+			std::size_t j = i + _tzcnt_u32(live);
+			live = _blsr_u32(live);
+			
+			std::uint64_t clear = ~words[j];
+			std::uint64_t base = low + 128 * j;
+			while(clear != 0){
+				out[count++] = base + 2 * _tzcnt_u64(clear);
+				clear = _blsr_u64(clear);
+			}
+		}
+	}
+	return count + extract_scalar(words + i, n - i, low + 128 * i, out + count);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt")))
+std::uint64_t count_avx512(const std::uint64_t* words, std::size_t n){
+	const __m512i ones = _mm512_set1_epi64(-1);
+	__m512i totals = _mm512_setzero_si512();
+	
+	std::size_t i = 0;
+	for(; i + 8 <= n; i += 8){
+		__m512i v = _mm512_xor_si512(_mm512_loadu_si512(words + i), ones);
+		totals = _mm512_add_epi64(totals, _mm512_popcnt_epi64(v));
+	}
+	
+	alignas(64) std::uint64_t lanes[8];
+	_mm512_store_si512(lanes, totals);
+	std::uint64_t total = 0;
+	for(std::uint64_t lane : lanes){
+		total += lane;
+	}
+	for(; i < n; ++i){
+		total += _mm_popcnt_u64(~words[i]);
+	}
+	return total;
+}
+
+
+
+//----------Dispatch----------
+
+kernel_set pick_kernels(){
+	const char* cap = std::getenv("SIEVE_KERNELS");
+	bool allow_avx512 = cap == NULL || (std::strcmp(cap, "scalar") != 0 && std::strcmp(cap, "avx2") != 0);
+	bool allow_avx2 = cap == NULL || std::strcmp(cap, "scalar") != 0;
+	
+	__builtin_cpu_init();
+	bool has_avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi") && __builtin_cpu_supports("popcnt");
+	if(allow_avx512 && has_avx2 && __builtin_cpu_supports("avx512f")){
+		return {"avx512", or_periodic_avx512, extract_avx512, __builtin_cpu_supports("avx512vpopcntdq") ? count_avx512 : count_avx2};
+	}
+	if(allow_avx2 && has_avx2){
+		return {"avx2", or_periodic_avx2, extract_avx2, count_avx2};
+	}
+	return {"scalar", or_periodic_scalar, extract_scalar, count_scalar};
+}
+
+const kernel_set& kernels(){
+	static const kernel_set chosen = pick_kernels();
+	return chosen;
+}
+
+}
+
+
+
+//----------Kernel Functions----------
+
+void or_periodic(std::uint64_t* words, std::size_t n, const std::uint64_t* sequence, std::size_t period, std::size_t start){
+	kernels().or_periodic(words, n, sequence, period, start);
+}
+
+std::size_t extract_clear_bits(const std::uint64_t* words, std::size_t n, std::uint64_t low, std::uint64_t* out){
+	return kernels().extract(words, n, low, out);
+}
+
+std::uint64_t count_clear_bits(const std::uint64_t* words, std::size_t n){
+	return kernels().count(words, n);
+}
+
+const char* sieve_kernel_name(){
+	return kernels().name;
+}
\ No newline at end of file
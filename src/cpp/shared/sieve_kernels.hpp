@@ -0,0 +1,26 @@
+#ifndef SIEVE_KERNELS_H_INCLUDED
+#define SIEVE_KERNELS_H_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+
+/*
+ * The inner loops of segmented_sieve, over arrays of 64-bit words where a set bit means composite.
+ * Each one has AVX-512, AVX2 and scalar versions, and the best one the CPU supports is picked the first time any of them is called.
+ * Setting the SIEVE_KERNELS environment variable to "scalar" or "avx2" caps the choice (e.g. to compare them).
+ */
+
+//ORs a periodic sequence of words into words[0, n): words[i] |= sequence[(start + i) % period].
+//The period has to be at least 8, and the sequence has to hold period + 8 words (the last 8 repeating the first) so vector loads can run past the end of a period.
+void or_periodic(std::uint64_t* words, std::size_t n, const std::uint64_t* sequence, std::size_t period, std::size_t start);
+
+//Writes low + 2 * bit for every clear bit in words[0, n), in order, and returns how many were written.  out needs room for 64 * n.
+std::size_t extract_clear_bits(const std::uint64_t* words, std::size_t n, std::uint64_t low, std::uint64_t* out);
+
+//Counts the clear bits in words[0, n).
+std::uint64_t count_clear_bits(const std::uint64_t* words, std::size_t n);
+
+//Which set of kernels is in use: "avx512", "avx2" or "scalar".
+const char* sieve_kernel_name();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,290 @@
+#ifndef SKIP_LIST_H_INCLUDED
+#define SKIP_LIST_H_INCLUDED
+
+#include <new>
+#include <bit>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include "cpp/shared/epoch.hpp"
+#include "cpp/shared/node_pool.hpp"
+
+/*
+ * This object represents a concurrent, ordered set, kept as a skip list with a lock in every node (Herlihy and Shavit's lazy skip list).
+ * Writers lock just the victim and the nodes right before it on each level, check nothing moved in the meantime, and then (un)link it,
+ * so writers on different parts of the list never wait for each other.  Searches and range scans take no locks at all:
+ * an element counts as being in the set once it's linked on every level, and stops counting as soon as its remover marks it.
+ * Nodes come from pool_allocate(), sized to their own height, and removed ones go to epoch_retire(), so nobody walking the list ever
+ * lands on freed memory.
+ */
+template <class T>
+class skip_list {
+public:
+	
+	using value_type = T;
+	
+	static constexpr int max_level = 24;		//Enough for 2^24 elements before searches start getting longer than they should.
+	
+	//Constructors/Destructor
+	skip_list() : head(node::create(value_type(), max_level)), levels(1) {}
+	skip_list(const skip_list&) = delete;
+	skip_list(skip_list&&) = delete;
+	~skip_list();
+	
+	//Assignment Operators
+	skip_list& operator=(const skip_list&) = delete;
+	skip_list& operator=(skip_list&&) = delete;
+	
+	//Set Operations
+	bool contains(const value_type&) const;		//Returns whether or not the element is in the set.  Never blocks.
+	bool insert(const value_type&);				//Adds the element.  Fails if it's already there.
+	bool remove(const value_type&);				//Removes the element.  Fails if it isn't there.
+	
+	//Calls f on every element from lo to hi (inclusive), in order.  Never blocks, and writers don't wait for it either,
+	//so elements added or removed during the scan may or may not show up.
+	template <class F>
+	void range(const value_type& lo, const value_type& hi, F f) const;
+
+private:
+	
+	struct alignas(std::atomic<void*>) node{
+		node(const value_type& v, int h) : value(v), height(h), marked(false), fully_linked(false), locked(false) {}
+		
+		value_type value;
+		int height;
+		std::atomic<bool> marked;			//Logically removed.
+		std::atomic<bool> fully_linked;		//Linked on every level of its tower.
+		std::atomic<bool> locked;
+		
+		//The tower of next pointers is allocated right after the node, only as tall as it needs to be.
+		std::atomic<node*>* next() {return reinterpret_cast<std::atomic<node*>*>(this + 1);}
+		
+		void lock();
+		void unlock() {locked.store(false, std::memory_order_release);}
+		
+		static std::size_t bytes(int h) {return sizeof(node) + h * sizeof(std::atomic<node*>);}
+		static node* create(const value_type& v, int h);
+		static void destroy(void* p);		//Has the signature epoch_retire() wants.
+	};
+	
+	static int random_level();
+	//Fills in the neighbours on every level in use (and at least the bottom height levels), and returns the highest level the element
+	//was found on, or -1.
+	int find(const value_type&, node** preds, node** succs, int height = 0) const;
+	static void unlock_preds(node** preds, int highest);
+	
+	node* head;		//A sentinel as tall as the list can get.  Its value is never looked at, and null at the end of a level stands for the tail.
+	std::atomic<int> levels;		//How tall the tallest node linked so far was.  Only a hint where searches start, so it never goes down.
+
+};
+
+template <class T>
+void skip_list<T>::node::lock(){
+	for(int spins = 0; locked.exchange(true, std::memory_order_acquire); ++spins){
+		while(locked.load(std::memory_order_relaxed)){
+			if(++spins > 64){
+				std::this_thread::yield();
+			}
+		}
+	}
+}
+
+template <class T>
+typename skip_list<T>::node* skip_list<T>::node::create(const value_type& v, int h){
+	node* n = new (pool_allocate(bytes(h))) node(v, h);
+	for(int i = 0; i < h; ++i){
+		new (&n->next()[i]) std::atomic<node*>(nullptr);
+	}
+	return n;
+}
+
+template <class T>
+void skip_list<T>::node::destroy(void* p){
+	node* n = static_cast<node*>(p);
+	int h = n->height;
+	n->~node();
+	pool_release(p, bytes(h));
+}
+
+template <class T>
+skip_list<T>::~skip_list(){
+	node* n = head;
+	while(n != nullptr){
+		node* next = n->next()[0].load();
+		node::destroy(n);
+		n = next;
+	}
+}
+
+template <class T>
+int skip_list<T>::random_level(){
+	static thread_local std::uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+	state ^= state << 13;		//xorshift64.
+	state ^= state >> 7;
+	state ^= state << 17;
+	int level = 1 + std::countr_zero(state | (std::uint64_t(1) << 63));		//Each level up is half as likely.
+	return level < max_level ? level : max_level;
+}
+
+template <class T>
+int skip_list<T>::find(const value_type& x, node** preds, node** succs, int height) const{
+	int found = -1;
+	node* pred = head;
+	int in_use = levels.load(std::memory_order_relaxed);
+	for(int level = (in_use > height ? in_use : height) - 1; level >= 0; --level){
+		node* curr = pred->next()[level].load(std::memory_order_acquire);
+		while(curr != nullptr && curr->value < x){
+			pred = curr;
+			curr = pred->next()[level].load(std::memory_order_acquire);
+		}
+		if(found == -1 && curr != nullptr && !(x < curr->value)){
+			found = level;
+		}
+		preds[level] = pred;
+		succs[level] = curr;
+	}
+	return found;
+}
+
+template <class T>
+void skip_list<T>::unlock_preds(node** preds, int highest){
+	for(int level = 0; level <= highest; ++level){
+		if(level == 0 || preds[level] != preds[level - 1]){		//Each pred was only locked once, on the lowest level it showed up on.
+			preds[level]->unlock();
+		}
+	}
+}
+
+template <class T>
+bool skip_list<T>::contains(const value_type& x) const{
+	epoch_guard guard;
+	node* preds[max_level];
+	node* succs[max_level];
+	int found = find(x, preds, succs);
+	return found != -1 && succs[found]->fully_linked.load(std::memory_order_acquire) && !succs[found]->marked.load(std::memory_order_acquire);
+}
+
+template <class T>
+bool skip_list<T>::insert(const value_type& x){
+	epoch_guard guard;
+	int top = random_level();
+	node* preds[max_level];
+	node* succs[max_level];
+	while(true){
+		int found = find(x, preds, succs, top);
+		if(found != -1){
+			node* existing = succs[found];
+			if(!existing->marked.load(std::memory_order_acquire)){
+				while(!existing->fully_linked.load(std::memory_order_acquire)){
+					std::this_thread::yield();		//Its inserter is still linking it in.
+				}
+				return false;
+			}
+			continue;		//Its remover is still unlinking it.
+		}
+		
+		int highest = -1;
+		bool valid = true;
+		for(int level = 0; valid && level < top; ++level){
+			node* pred = preds[level];
+			node* succ = succs[level];
+			if(level == 0 || pred != preds[level - 1]){
+				pred->lock();
+			}
+			highest = level;
+			valid = !pred->marked.load() && (succ == nullptr || !succ->marked.load()) && pred->next()[level].load() == succ;
+		}
+		if(!valid){
+			unlock_preds(preds, highest);
+			continue;
+		}
+		
+		node* fresh = node::create(x, top);
+		for(int level = 0; level < top; ++level){
+			fresh->next()[level].store(succs[level], std::memory_order_relaxed);
+		}
+		for(int level = 0; level < top; ++level){
+			preds[level]->next()[level].store(fresh, std::memory_order_release);
+		}
+		fresh->fully_linked.store(true, std::memory_order_release);
+		unlock_preds(preds, highest);
+		
+		int in_use = levels.load(std::memory_order_relaxed);
+		while(in_use < top && !levels.compare_exchange_weak(in_use, top, std::memory_order_relaxed)){}
+		return true;
+	}
+}
+
+template <class T>
+bool skip_list<T>::remove(const value_type& x){
+	epoch_guard guard;
+	node* victim = nullptr;
+	bool is_marked = false;
+	int height = 0;
+	node* preds[max_level];
+	node* succs[max_level];
+	while(true){
+		int found = find(x, preds, succs, height);
+		if(!is_marked){
+			if(found == -1){
+				return false;
+			}
+			victim = succs[found];
+			if(victim->height - 1 > found && height < victim->height && victim->fully_linked.load(std::memory_order_acquire)){
+				height = victim->height;		//Its inserter hadn't raised levels yet when find looked, so look again from the top of its tower.
+				continue;
+			}
+			if(!victim->fully_linked.load(std::memory_order_acquire) || victim->height - 1 != found || victim->marked.load(std::memory_order_acquire)){
+				return false;		//Either still being inserted (so not in the set yet), or already being removed by someone else.
+			}
+			
+			victim->lock();
+			if(victim->marked.load()){
+				victim->unlock();
+				return false;
+			}
+			victim->marked.store(true, std::memory_order_release);
+			is_marked = true;
+			height = victim->height;
+		}
+		
+		int highest = -1;
+		bool valid = true;
+		for(int level = 0; valid && level < victim->height; ++level){
+			node* pred = preds[level];
+			if(level == 0 || pred != preds[level - 1]){
+				pred->lock();
+			}
+			highest = level;
+			valid = !pred->marked.load() && pred->next()[level].load() == victim;
+		}
+		if(!valid){
+			unlock_preds(preds, highest);
+			continue;
+		}
+		
+		for(int level = victim->height - 1; level >= 0; --level){
+			preds[level]->next()[level].store(victim->next()[level].load(std::memory_order_relaxed), std::memory_order_release);
+		}
+		victim->unlock();
+		unlock_preds(preds, highest);
+		epoch_retire(victim, &node::destroy);
+		return true;
+	}
+}
+
+template <class T>
+template <class F>
+void skip_list<T>::range(const value_type& lo, const value_type& hi, F f) const{
+	epoch_guard guard;
+	node* preds[max_level];
+	node* succs[max_level];
+	find(lo, preds, succs);
+	for(node* curr = succs[0]; curr != nullptr && !(hi < curr->value); curr = curr->next()[0].load(std::memory_order_acquire)){
+		if(curr->fully_linked.load(std::memory_order_acquire) && !curr->marked.load(std::memory_order_acquire)){
+			f(curr->value);
+		}
+	}
+}
+
+#endif
\ No newline at end of file
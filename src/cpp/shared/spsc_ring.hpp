@@ -0,0 +1,154 @@
+#ifndef SPSC_RING_H_INCLUDED
+#define SPSC_RING_H_INCLUDED
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include "cpp/shared/thread_pool.hpp"
+
+/*
+ * This object represents a bounded, single-producer/single-consumer channel.
+ * It's a fixed ring of slots which are reused lap after lap, so its memory never grows, and elements move through it in batches:
+ * one push or pop moves as many elements as fit, with a single atomic publish (and at most one wake-up) for the whole batch.
+ * Either side only blocks (on an atomic, futex-style) after spinning for a while.
+ */
+template <class T>
+class spsc_ring {
+public:
+	
+	using value_type = T;
+	
+	static constexpr std::size_t default_capacity = 1024;
+	
+	//Constructors/Destructor
+	spsc_ring(std::size_t capacity = default_capacity);		//Rounded up to a power of two.
+	spsc_ring(const spsc_ring&) = delete;
+	spsc_ring(spsc_ring&&) = delete;
+	~spsc_ring() = default;
+	
+	//Assignment Operators
+	spsc_ring& operator=(const spsc_ring&) = delete;
+	spsc_ring& operator=(spsc_ring&&) = delete;
+	
+	//Channel Operations
+	void push(const value_type* first, std::size_t n);		//Adds n elements to the end of the channel.  Blocks while it's full.  Producer only.
+	std::size_t pop(value_type* out, std::size_t max);		//Removes up to max elements.  Blocks while it's empty and open, returns zero once it's closed and empty.  Consumer only.
+	
+	//Clean-up Operations
+	bool closed() const {return is_closed.load();}	//Returns whether or not the channel is closed.
+	void close();									//Closes the channel.  The consumer drains whatever is left, then pops return zero.  Producer only.
+
+private:
+	
+	static constexpr int spin_limit = 64;
+	
+	static std::size_t round_up(std::size_t n);
+	
+	std::vector<value_type> slots;
+	const std::size_t mask;
+	
+	alignas(64) std::atomic<std::size_t> head;		//Next position to pop from.  Only the consumer writes it.
+	alignas(64) std::atomic<std::size_t> tail;		//Next position to push into.  Only the producer writes it.
+	alignas(64) std::atomic<unsigned> pushes;		//Bumped whenever the consumer might be asleep, and on close.  The consumer sleeps on this.
+	std::atomic<bool> is_closed;
+	std::atomic<bool> producer_sleeping;
+	std::atomic<bool> consumer_sleeping;
+
+};
+
+template <class T>
+spsc_ring<T>::spsc_ring(std::size_t capacity) : slots(round_up(capacity)), mask(round_up(capacity) - 1), head(0), tail(0), pushes(0), is_closed(false), producer_sleeping(false), consumer_sleeping(false) {}
+
+template <class T>
+std::size_t spsc_ring<T>::round_up(std::size_t n){
+	std::size_t size = 1;
+	while(size < n){
+		size *= 2;
+	}
+	return size;
+}
+
+template <class T>
+void spsc_ring<T>::push(const value_type* first, std::size_t n){
+	std::size_t pos = tail.load(std::memory_order_relaxed);
+	for(int spins = 0; n > 0; ++spins){
+		std::size_t seen = head.load(std::memory_order_acquire);
+		std::size_t room = std::min(slots.size() - (pos - seen), n);
+		if(room == 0){
+			if(spins < spin_limit){
+				std::this_thread::yield();
+			}else{
+				producer_sleeping.store(true);
+				if(head.load() == seen){
+					blocking_scope scope;
+					head.wait(seen);
+				}
+				producer_sleeping.store(false);
+			}
+			continue;
+		}
+		
+		for(std::size_t i = 0; i < room; ++i){
+			slots[(pos + i) & mask] = first[i];
+		}
+		first += room;
+		n -= room;
+		pos += room;
+		spins = 0;
+		
+		tail.store(pos);
+		if(consumer_sleeping.load()){
+			pushes.fetch_add(1);
+			pushes.notify_one();
+		}
+	}
+}
+
+template <class T>
+std::size_t spsc_ring<T>::pop(value_type* out, std::size_t max){
+	std::size_t pos = head.load(std::memory_order_relaxed);
+	for(int spins = 0; ; ++spins){
+		std::size_t seen = tail.load(std::memory_order_acquire);
+		std::size_t count = std::min(seen - pos, max);
+		if(count > 0){
+			for(std::size_t i = 0; i < count; ++i){
+				out[i] = std::move(slots[(pos + i) & mask]);
+			}
+			head.store(pos + count);
+			if(producer_sleeping.load()){
+				head.notify_one();
+			}
+			return count;
+		}
+		if(is_closed.load()){
+			if(tail.load(std::memory_order_acquire) == seen){
+				return 0;
+			}
+			continue;		//Something was pushed just before closing.
+		}
+		
+		if(spins < spin_limit){
+			std::this_thread::yield();
+		}else{
+			unsigned epoch = pushes.load();
+			consumer_sleeping.store(true);
+			if(tail.load() == seen && !is_closed.load()){
+				blocking_scope scope;
+				pushes.wait(epoch);
+			}
+			consumer_sleeping.store(false);
+		}
+	}
+}
+
+template <class T>
+void spsc_ring<T>::close(){
+	is_closed.store(true);
+	pushes.fetch_add(1);
+	pushes.notify_one();
+}
+
+#endif
\ No newline at end of file
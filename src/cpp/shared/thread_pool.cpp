@@ -0,0 +1,248 @@
+#include <chrono>
+#include <iterator>
+#include "cpp/shared/thread_pool.hpp"
+
+namespace{
+
+constexpr std::chrono::milliseconds monitor_period(10);
+constexpr std::chrono::milliseconds surplus_linger(100);		//How long a surplus worker stays parked before it retires.
+
+thread_local thread_pool* this_pool = NULL;
+thread_local std::size_t next_victim = 0;		//Where the calling worker starts looking for something to steal, so thieves spread out.
+
+}
+
+thread_local thread_pool::worker_queue* thread_pool::this_queue = NULL;
+
+
+
+//----------Thread Pool Functions----------
+
+thread_pool::thread_pool(int n, int max_extra) : target(n > 0 ? n : 1), max_threads(target + (max_extra > 0 ? max_extra : 0)), lock(), queues_lock(), work_available(), all_done(), stop_monitor(), queues(), threads(), retired(), monitor_thread(), next_queue(0), live(0), blocked(0), idle(0), stopping(false), queued(0), started(0), outstanding(0) {
+	std::unique_lock lk(lock);
+	
+	for(int i = 0; i < target; ++i){
+		spawn_worker();
+	}
+	monitor_thread = std::thread(&thread_pool::monitor, this);
+}
+
+thread_pool::~thread_pool(){
+	wait_idle();
+	{
+		std::unique_lock lk(lock);
+		stopping = true;
+		work_available.notify_all();
+		stop_monitor.notify_all();
+	}
+	
+	if(monitor_thread.joinable()){
+		monitor_thread.join();
+	}
+	for(auto i = threads.begin(); i != threads.end(); ++i){	//Nothing spawns or retires workers once stopping is set.
+		if(i->joinable()){
+			i->join();
+		}
+	}
+	for(auto i = retired.begin(); i != retired.end(); ++i){
+		if(i->joinable()){
+			i->join();
+		}
+	}
+}
+
+thread_pool* thread_pool::current(){
+	return this_pool;
+}
+
+void thread_pool::submit(task t){
+	++outstanding;
+	++queued;
+	
+	bool from_worker = (this_pool == this);
+	if(from_worker){
+		std::unique_lock q_lk(this_queue->lock);
+		this_queue->tasks.push_back(std::move(t));
+	}
+	
+	std::unique_lock lk(lock);
+	if(!from_worker){		//Submitted from outside the pool, hand it to the next worker in turn.
+		worker_queue& q = *queues[next_queue++ % queues.size()];
+		std::unique_lock q_lk(q.lock);
+		q.tasks.push_back(std::move(t));
+	}
+	if(idle > 0){
+		work_available.notify_one();
+	}else{
+		compensate();
+	}
+}
+
+void thread_pool::wait_idle(){
+	std::unique_lock lk(lock);
+	
+	all_done.wait(lk, [this](){return outstanding.load() == 0;});
+}
+
+void thread_pool::begin_blocking(){
+	std::unique_lock lk(lock);
+	
+	++blocked;
+	compensate();
+}
+
+void thread_pool::end_blocking(){
+	std::unique_lock lk(lock);
+	
+	--blocked;		//Any surplus workers retire the next time they run out of work.
+}
+
+void thread_pool::spawn_worker(){
+	{
+		std::unique_lock queues_lk(queues_lock);
+		queues.push_back(std::make_unique<worker_queue>());
+	}
+	++live;
+	threads.emplace_back();
+	threads.back() = std::thread(&thread_pool::work, this, queues.back().get(), std::prev(threads.end()));
+}
+
+void thread_pool::compensate(){
+	if(stopping || idle > 0 || queued.load() == 0 || live - blocked >= target){		//An idle worker gets the queued task by itself.
+		return;
+	}
+	if(live < max_threads){
+		spawn_worker();
+	}
+}
+
+bool thread_pool::find_task(worker_queue* own, task& t){
+	{
+		std::unique_lock q_lk(own->lock);
+		if(!own->tasks.empty()){
+			t = std::move(own->tasks.back());
+			own->tasks.pop_back();
+			return true;
+		}
+	}
+	
+	std::shared_lock queues_lk(queues_lock);
+	std::size_t start = next_victim++;
+	for(std::size_t i = 0; i < queues.size(); ++i){
+		worker_queue* victim = queues[(start + i) % queues.size()].get();
+		if(victim != own){
+			std::unique_lock q_lk(victim->lock);
+			if(!victim->tasks.empty()){
+				t = std::move(victim->tasks.front());
+				victim->tasks.pop_front();
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void thread_pool::work(worker_queue* own, std::list<std::thread>::iterator self){
+	this_pool = this;
+	this_queue = own;
+	
+	task t;
+	while(true){
+		if(find_task(own, t)){
+			--queued;
+			++started;
+			t();
+			t = nullptr;
+			
+			if(--outstanding == 0){
+				std::unique_lock lk(lock);
+				all_done.notify_all();
+			}
+			continue;
+		}
+		
+		std::unique_lock lk(lock);
+		if(queued.load() > 0){
+			continue;		//Something was submitted while we were looking.
+		}
+		if(stopping){
+			break;
+		}
+		
+		++idle;
+		bool expired = false;
+		if(live - blocked > target){	//Surplus, park for a while in case another worker blocks.
+			expired = work_available.wait_for(lk, surplus_linger) == std::cv_status::timeout;
+		}else{
+			work_available.wait(lk);
+		}
+		--idle;
+		
+		if(expired && !stopping && queued.load() == 0 && live - blocked > target){		//Still surplus, retire.  Nothing is queued anywhere, so its deque is empty.
+			std::unique_lock queues_lk(queues_lock);
+			for(auto i = queues.begin(); i != queues.end(); ++i){
+				if(i->get() == own){
+					queues.erase(i);
+					break;
+				}
+			}
+			retired.splice(retired.end(), threads, self);		//A thread can't join itself, so the monitor does it.
+			--live;
+			break;
+		}
+	}
+	
+	this_pool = NULL;
+	this_queue = NULL;
+}
+
+void thread_pool::monitor(){
+	std::unique_lock lk(lock);
+	
+	long last = started.load();
+	while(!stopping){
+		stop_monitor.wait_for(lk, monitor_period);
+		if(stopping){
+			break;
+		}
+		
+		long now = started.load();
+		if(blocked > 0 && queued.load() > 0 && now == last){		//A backstop, in case a stand-in was missed.  Busy workers don't count.
+			compensate();
+		}
+		last = now;
+		
+		if(!retired.empty()){
+			std::list<std::thread> joining;
+			joining.swap(retired);
+			lk.unlock();
+			for(auto i = joining.begin(); i != joining.end(); ++i){
+				i->join();
+			}
+			lk.lock();
+		}
+	}
+}
+
+
+
+//----------Actor Group Functions----------
+
+void actor_group::join(){
+	std::unique_lock lk(lock);
+	
+	while(!threads.empty()){
+		std::vector<std::thread> joining;
+		joining.swap(threads);
+		lk.unlock();
+		for(auto i = joining.begin(); i != joining.end(); ++i){
+			if(i->joinable()){
+				i->join();
+			}
+		}
+		lk.lock();
+	}
+	
+	blocking_scope scope;
+	done.wait(lk, [this](){return outstanding == 0;});
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+#ifndef THREAD_POOL_H_INCLUDED
+#define THREAD_POOL_H_INCLUDED
+
+#include <list>
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstddef>
+#include <utility>
+#include <functional>
+#include <shared_mutex>
+#include <condition_variable>
+
+/*
+ * This object represents a work-stealing thread pool.
+ * Every worker owns a deque: it pushes and pops its own tasks at the back, and idle workers steal from the front of everyone else's.
+ * Stealing only locks the deque it steals from, so thieves don't queue up behind submits or each other.
+ * Tasks are allowed to block.  While workers are blocked inside a semaphore or a queue (see blocking_scope) and tasks are waiting,
+ * the pool brings in stand-ins, waking a parked one if it has any and only spawning a thread if not.  There are never more than
+ * max_extra stand-ins, so with that many tasks blocked at once, the rest of the queue waits for one of them to finish.
+ * Tasks which wait on tasks queued behind them (like a pipeline of actors) need a max_extra big enough for all of them.
+ * Surplus workers park for a while once they run out of work, in case they're needed again, and then retire.
+ * Workers which are merely busy (or stuck somewhere that isn't a blocking_scope) are never compensated for.
+ */
+class thread_pool{
+public:
+	
+	using task = std::function<void()>;
+	
+	static constexpr int default_max_extra = 256;
+	
+	//Constructors/Destructor.
+	thread_pool(int n = std::thread::hardware_concurrency(), int max_extra = default_max_extra);
+	thread_pool(const thread_pool&) = delete;
+	thread_pool(thread_pool&&) = delete;
+	~thread_pool();		//Waits for every submitted task to finish.
+	
+	//Assignment Operators.
+	thread_pool& operator=(const thread_pool&) = delete;
+	thread_pool& operator=(thread_pool&&) = delete;
+	
+	//Pool Operations.
+	void submit(task t);		//Queues a task.  From inside a worker it goes on that worker's own deque.
+	void wait_idle();			//Blocks until every submitted task has finished.
+	int size() const {return target;}
+	
+	//The pool (if any) running on the calling thread.
+	static thread_pool* current();
+
+private:
+	
+	struct worker_queue{
+		std::mutex lock;
+		std::deque<task> tasks;
+	};
+	
+	//Blocking Notifications.
+	friend class blocking_scope;
+	void begin_blocking();
+	void end_blocking();
+	
+	//Worker Functions.
+	void spawn_worker();		//Needs lock.
+	void compensate();		//Brings in a stand-in if tasks are waiting and blocked workers have left too few running.  Needs lock.
+	void work(worker_queue* own, std::list<std::thread>::iterator self);
+	bool find_task(worker_queue* own, task& t);
+	void monitor();
+	
+	static thread_local worker_queue* this_queue;	//The calling worker's own deque.
+	
+	const int target;			//How many unblocked workers the pool tries to keep.
+	const int max_threads;		//target plus the most stand-ins allowed.
+	
+	mutable std::mutex lock;	//Protects everything below, except for the contents of each worker_queue.
+	mutable std::shared_mutex queues_lock;		//Also protects queues (but not their contents).  Writers hold both locks, so readers only need one.
+	std::condition_variable work_available;
+	std::condition_variable all_done;
+	std::condition_variable stop_monitor;
+	std::vector<std::unique_ptr<worker_queue>> queues;
+	std::list<std::thread> threads;
+	std::list<std::thread> retired;		//Workers which have retired (or are just about to exit), waiting for the monitor to join them.
+	std::thread monitor_thread;
+	std::size_t next_queue;		//Round-robin index for tasks submitted from outside the pool.
+	int live;					//Workers which haven't retired.
+	int blocked;				//Workers inside a blocking_scope.
+	int idle;					//Workers waiting for work.
+	bool stopping;
+	
+	std::atomic<long> queued;		//Tasks submitted but not yet started.
+	std::atomic<long> started;		//Tasks ever started.  The monitor checks this for progress.
+	std::atomic<long> outstanding;	//Tasks submitted but not yet finished.
+
+};
+
+/*
+ * Declares that the calling thread is about to block.  If that thread is a pool worker, the pool can bring in another worker meanwhile.
+ * Does nothing on threads which don't belong to a pool.
+ */
+class blocking_scope{
+public:
+	
+	//Constructors/Destructor.
+	blocking_scope() : pool(thread_pool::current()) {if(pool != NULL){pool->begin_blocking();}}
+	blocking_scope(const blocking_scope&) = delete;
+	blocking_scope(blocking_scope&&) = delete;
+	~blocking_scope() {if(pool != NULL){pool->end_blocking();}}
+	
+	//Assignment Operators.
+	blocking_scope& operator=(const blocking_scope&) = delete;
+	blocking_scope& operator=(blocking_scope&&) = delete;
+
+private:
+	
+	thread_pool* pool;
+
+};
+
+/*
+ * Sleeps for (at least) the given time inside a blocking_scope, so a pool worker which sleeps doesn't hold up the rest of the pool.
+ */
+template <class Rep, class Period>
+void blocking_sleep_for(const std::chrono::duration<Rep, Period>& d){
+	blocking_scope scope;
+	std::this_thread::sleep_for(d);
+}
+
+/*
+ * A group of actors which can be joined together.  Without a pool every actor gets its own std::thread, like before.
+ * With a pool each actor becomes a task on it.
+ */
+class actor_group{
+public:
+	
+	//Constructors/Destructor.
+	actor_group(thread_pool* p = NULL) : pool(p), threads(), lock(), done(), outstanding(0) {}
+	actor_group(const actor_group&) = delete;
+	actor_group(actor_group&&) = delete;
+	~actor_group() {join();}
+	
+	//Assignment Operators.
+	actor_group& operator=(const actor_group&) = delete;
+	actor_group& operator=(actor_group&&) = delete;
+	
+	//Group Operations.
+	template <class F, class... Args>
+	void spawn(F&& f, Args&&... args);		//Same arguments as the std::thread constructor.  Actors may spawn more actors into their own group.
+	void join();							//Waits for every actor in the group, including ones spawned while waiting.
+
+private:
+	
+	thread_pool* pool;
+	std::vector<std::thread> threads;
+	
+	std::mutex lock;		//Protects threads and outstanding.
+	std::condition_variable done;
+	long outstanding;
+
+};
+
+template <class F, class... Args>
+void actor_group::spawn(F&& f, Args&&... args){
+	if(pool == NULL){
+		std::thread actor(std::forward<F>(f), std::forward<Args>(args)...);
+		std::unique_lock lk(lock);
+		threads.push_back(std::move(actor));
+		return;
+	}
+	
+	{
+		std::unique_lock lk(lock);
+		++outstanding;
+	}
+	auto actor = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
+	pool->submit([this, actor]() mutable {
+		actor();
+		
+		std::unique_lock lk(lock);
+		if(--outstanding == 0){
+			done.notify_all();
+		}
+	});
+}
+
+#endif
\ No newline at end of file
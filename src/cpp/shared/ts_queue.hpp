@@ -3,8 +3,14 @@
 
 #include <mutex>
 #include <queue>
+#include <chrono>
 #include <cstdlib>
+#include <cstddef>
+#include <utility>
+#include <optional>
+#include <type_traits>
 #include <condition_variable>
+#include "cpp/shared/thread_pool.hpp"
 
 /*
  * This object represents a thread-safe queue.
@@ -16,7 +22,7 @@ public:
 	using value_type = T;
 	
 	//Constructors/Destructor
-	ts_queue(long max = -1) : lock(), not_empty(), queue(), is_closed(false), maximum(max) {}
+	ts_queue(long max = -1) : lock(), not_empty(), queue(), waiting(0), is_closed(false), maximum(max) {}
 	ts_queue(const ts_queue&) = delete;
 	ts_queue(ts_queue&&) = delete;
 	~ts_queue() {clear(); close();}
@@ -27,10 +33,23 @@ public:
 	
 	//Queue Operations
 	bool empty() const {std::unique_lock lk(lock);  return queue.empty();}		//Returns whether or not the queue is empty.
-	bool enqueue(const value_type&);											//Adds an element to the end of the queue.
+	bool enqueue(const value_type&) requires std::is_copy_constructible_v<T>;	//Adds an element to the end of the queue.
+	bool enqueue(value_type&&);													//Adds an element to the end of the queue, moving it in.
+	template <class... Args>
+	bool emplace(Args&&...);													//Constructs an element in place at the end of the queue.
 	bool dequeue(value_type&);													//Removes an element from the front of the queue.  Blocks if queue is not closed, doesn't otherwise.
+	std::optional<value_type> try_dequeue();									//Removes an element from the front of the queue if there is one.  Never blocks.
+	bool try_dequeue(value_type&);												//Same as above, but moves the element into the argument.  Returns false if the queue was empty.
+	template <class Rep, class Period>
+	bool dequeue_for(value_type&, const std::chrono::duration<Rep, Period>&);	//Like dequeue, but gives up and returns false once the timeout expires.
 	void clear();																//Removes everything from the queue.
 	
+	//Bulk Queue Operations
+	template <class InputIt>
+	InputIt enqueue_bulk(InputIt, InputIt);				//Copies elements from [first, last) in until the queue fills up (pass std::make_move_iterator to move them).  Returns an iterator past the last one added.
+	template <class OutputIt>
+	std::size_t dequeue_bulk(OutputIt, std::size_t);	//Moves up to max_count elements into out.  Blocks like dequeue until at least one is available.
+	
 	//Clean-up Operations
 	bool closed() const {std::unique_lock lk(lock);  return is_closed;}					//Returns whether or not the queue is closed.
 	void close() {std::unique_lock lk(lock); is_closed = true; not_empty.notify_all();}	//Closes the queue.  Prevents enqueues, makes dequeues non-blocking.
@@ -38,9 +57,12 @@ public:
 
 private:
 	
+	void wake(std::size_t);
+	
 	mutable std::mutex lock;
 	mutable std::condition_variable not_empty;
 	std::queue<value_type> queue;
+	std::size_t waiting;		//How many dequeuers are blocked on not_empty.
 	
 	mutable bool is_closed;
 	long maximum;
@@ -48,15 +70,26 @@ private:
 };
 
 template <class T>
-bool ts_queue<T>::enqueue(const value_type& elem){
+bool ts_queue<T>::enqueue(const value_type& elem) requires std::is_copy_constructible_v<T> {
+	return emplace(elem);
+}
+
+template <class T>
+bool ts_queue<T>::enqueue(value_type&& elem){
+	return emplace(std::move(elem));
+}
+
+template <class T>
+template <class... Args>
+bool ts_queue<T>::emplace(Args&&... args){
 	std::unique_lock lk(lock);
 	
 	if(is_closed || (maximum >= 0 && queue.size() == std::size_t(maximum))){
 		return false;
 	}
 	
-	queue.push(elem);
-	not_empty.notify_one();
+	queue.emplace(std::forward<Args>(args)...);
+	wake(1);
 	return true;
 }
 
@@ -67,16 +100,125 @@ bool ts_queue<T>::dequeue(value_type& ret){
 	if(is_closed && queue.empty()){
 		return false;		//In case it was closed and emptied before waiting.
 	}
-	not_empty.wait(lk, [=](){return !queue.empty() || is_closed;});
+	++waiting;
+	if(queue.empty() && !is_closed){
+		blocking_scope scope;
+		not_empty.wait(lk, [this](){return !queue.empty() || is_closed;});
+	}
+	--waiting;
 	if(is_closed && queue.empty()){
 		return false;		//In case it was closed and emptied while waiting.
 	}
 	
-	ret = queue.front();
+	ret = std::move(queue.front());
+	queue.pop();
+	return true;
+}
+
+template <class T>
+std::optional<T> ts_queue<T>::try_dequeue(){
+	std::unique_lock lk(lock);
+	
+	if(queue.empty()){
+		return std::nullopt;
+	}
+	
+	std::optional<value_type> ret(std::move(queue.front()));
+	queue.pop();
+	return ret;
+}
+
+template <class T>
+bool ts_queue<T>::try_dequeue(value_type& ret){
+	std::unique_lock lk(lock);
+	
+	if(queue.empty()){
+		return false;
+	}
+	
+	ret = std::move(queue.front());
+	queue.pop();
+	return true;
+}
+
+template <class T>
+template <class Rep, class Period>
+bool ts_queue<T>::dequeue_for(value_type& ret, const std::chrono::duration<Rep, Period>& timeout){
+	std::unique_lock lk(lock);
+	
+	if(is_closed && queue.empty()){
+		return false;
+	}
+	++waiting;
+	if(queue.empty() && !is_closed){
+		blocking_scope scope;
+		not_empty.wait_for(lk, timeout, [this](){return !queue.empty() || is_closed;});
+	}
+	--waiting;
+	if(queue.empty()){
+		return false;		//Either timed out or was closed and emptied while waiting.
+	}
+	
+	ret = std::move(queue.front());
 	queue.pop();
 	return true;
 }
 
+template <class T>
+template <class InputIt>
+InputIt ts_queue<T>::enqueue_bulk(InputIt first, InputIt last){
+	std::unique_lock lk(lock);
+	
+	if(is_closed){
+		return first;
+	}
+	
+	std::size_t added = 0;
+	for(; first != last && (maximum < 0 || queue.size() < std::size_t(maximum)); ++first){
+		queue.push(*first);
+		++added;
+	}
+	wake(added);
+	return first;
+}
+
+template <class T>
+template <class OutputIt>
+std::size_t ts_queue<T>::dequeue_bulk(OutputIt out, std::size_t max_count){
+	std::unique_lock lk(lock);
+	
+	if(max_count == 0 || (is_closed && queue.empty())){
+		return 0;
+	}
+	++waiting;
+	if(queue.empty() && !is_closed){
+		blocking_scope scope;
+		not_empty.wait(lk, [this](){return !queue.empty() || is_closed;});
+	}
+	--waiting;
+	
+	std::size_t removed = 0;
+	for(; removed < max_count && !queue.empty(); ++removed){
+		*out = std::move(queue.front());
+		++out;
+		queue.pop();
+	}
+	return removed;
+}
+
+template <class T>
+void ts_queue<T>::wake(std::size_t items){
+	if(items >= waiting){
+		if(waiting > 0){
+			not_empty.notify_all();
+		}
+	}else{
+		for(std::size_t i = 0; i < items; ++i){
+			not_empty.notify_one();
+		}
+	}
+}
+
 template <class T>
 void ts_queue<T>::clear(){
 	std::unique_lock lk(lock);
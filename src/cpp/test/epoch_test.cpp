@@ -0,0 +1,129 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include <iostream>
+#include "cpp/shared/epoch.hpp"
+
+/*
+ * Tests for epoch-based reclamation.  Exits non-zero if any of them fail.
+ * Every test counts its own objects, since anything an earlier test left in a limbo list may get freed at any time.
+ */
+
+struct counted{
+	counted(std::atomic<int>* c) : count(c) {}
+	~counted() {count->fetch_add(1);}
+	
+	std::atomic<int>* count;
+};
+
+//Spins until the counter gets to n.
+void wait_for(const std::atomic<int>& counter, int n){
+	while(counter.load() < n){
+		std::this_thread::yield();
+	}
+}
+
+/*
+ * Threads retire objects, half of them from inside guards of their own, while an older guard is alive: none of it may be freed,
+ * however often they collect.  Once that guard goes, a few collects each are enough to free every last one.
+ */
+bool held_by_older_guard(){
+	constexpr int threads = 4;
+	constexpr int per_thread = 1000;
+	std::atomic<int> reclaimed(0);
+	std::atomic<int> retired(0);
+	std::atomic<int> released(0);
+	std::atomic<int> collected(0);
+	
+	bool held = true;
+	std::vector<std::thread> retirers;
+	{
+		epoch_guard oldest;
+		for(int t = 0; t < threads; ++t){
+			retirers.push_back(std::thread([&, t](){
+				for(int i = 0; i < per_thread; ++i){
+					if(t % 2 == 0){
+						epoch_guard pinned;
+						epoch_retire(new counted(&reclaimed));
+					}else{
+						epoch_retire(new counted(&reclaimed));
+					}
+					if(i % 100 == 0){
+						epoch_collect();
+					}
+				}
+				retired.fetch_add(1);
+				
+				wait_for(released, 1);
+				for(int i = 0; i < 3; ++i){		//The epoch has to move on twice, and each collect moves it at most once.
+					epoch_collect();
+				}
+				collected.fetch_add(1);
+			}));
+		}
+		
+		wait_for(retired, threads);
+		epoch_collect();
+		held = reclaimed.load() == 0;
+	}
+	released.store(1);
+	
+	wait_for(collected, threads);
+	for(auto i = retirers.begin(); i != retirers.end(); ++i){
+		i->join();
+	}
+	return held && reclaimed.load() == threads * per_thread;
+}
+
+/*
+ * A thread retires objects while a guard holds them back, and exits.  Its record, limbo list and all, goes to a later thread,
+ * which frees them once it collects.  Enough threads take records at once that one of them has to get that one.
+ */
+bool handed_on(){
+	constexpr int retires = 100;
+	constexpr int claimers = 32;		//More than this program ever has threads at once, so every free record gets claimed.
+	std::atomic<int> reclaimed(0);
+	
+	bool held = true;
+	{
+		epoch_guard oldest;
+		std::thread retirer([&](){
+			for(int i = 0; i < retires; ++i){
+				epoch_retire(new counted(&reclaimed));
+			}
+		});
+		retirer.join();
+		held = reclaimed.load() == 0;
+	}
+	
+	std::atomic<int> claimed(0);
+	std::vector<std::thread> threads;
+	for(int t = 0; t < claimers; ++t){
+		threads.push_back(std::thread([&](){
+			epoch_collect();		//Claims a record.
+			claimed.fetch_add(1);
+			wait_for(claimed, claimers);
+			for(int i = 0; i < 3; ++i){
+				epoch_collect();
+			}
+		}));
+	}
+	for(auto i = threads.begin(); i != threads.end(); ++i){
+		i->join();
+	}
+	return held && reclaimed.load() == retires;
+}
+
+bool run(const std::string& name, bool (*test)()){
+	bool passed = test();
+	std::cout << "(" << name << ") " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+int main(){
+	bool passed = true;
+	passed = run("held_by_older_guard", held_by_older_guard) && passed;
+	passed = run("handed_on", handed_on) && passed;
+	return passed ? 0 : 1;
+}
\ No newline at end of file
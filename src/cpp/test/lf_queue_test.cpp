@@ -0,0 +1,180 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <iostream>
+#include <stdexcept>
+#include "cpp/shared/lf_queue.hpp"
+
+/*
+ * Tests for lf_queue.  Exits non-zero if any of them fail.
+ * Build with -fsanitize=thread too, since the slots' sequence numbers are all that keeps producers and consumers apart.
+ */
+
+typedef std::chrono::steady_clock testing_clock;
+
+//Several producers and consumers share a small queue.  Every element comes out exactly once, and each producer's elements
+//come out in the order they went in (as far as any one consumer can tell).
+bool mpmc(){
+	constexpr int producers = 4;
+	constexpr int consumers = 4;
+	constexpr int per_producer = 20000;
+	lf_queue<int> queue(64);
+	
+	std::vector<std::atomic<int>> seen(producers * per_producer);
+	std::atomic<bool> in_order(true);
+	std::vector<std::thread> threads;
+	for(int c = 0; c < consumers; ++c){
+		threads.push_back(std::thread([&](){
+			std::vector<int> last(producers, -1);
+			int value;
+			while(queue.dequeue(value)){
+				seen[value].fetch_add(1);
+				int producer = value / per_producer;
+				if(value <= last[producer]){
+					in_order.store(false);
+				}
+				last[producer] = value;
+			}
+		}));
+	}
+	
+	std::vector<std::thread> writers;
+	for(int p = 0; p < producers; ++p){
+		writers.push_back(std::thread([&, p](){
+			for(int i = p * per_producer; i < (p + 1) * per_producer; ++i){
+				while(!queue.enqueue(i)){
+					std::this_thread::yield();		//Full, wait for the consumers to catch up.
+				}
+			}
+		}));
+	}
+	for(auto i = writers.begin(); i != writers.end(); ++i){
+		i->join();
+	}
+	queue.close();
+	for(auto i = threads.begin(); i != threads.end(); ++i){
+		i->join();
+	}
+	
+	for(auto i = seen.begin(); i != seen.end(); ++i){
+		if(i->load() != 1){
+			return false;
+		}
+	}
+	return in_order.load() && queue.empty();
+}
+
+//Enqueues fail once the ring is full, and work again as soon as something is dequeued.  Elements come out first in, first out.
+bool full(){
+	lf_queue<int> queue(4);
+	for(int i = 0; i < 4; ++i){
+		if(!queue.enqueue(i)){
+			return false;
+		}
+	}
+	if(queue.enqueue(4)){
+		return false;
+	}
+	
+	int value;
+	if(!queue.dequeue(value) || value != 0 || !queue.enqueue(4)){
+		return false;
+	}
+	for(int i = 1; i <= 4; ++i){
+		if(!queue.dequeue(value) || value != i){
+			return false;
+		}
+	}
+	return queue.empty();
+}
+
+//A dequeue on an empty queue blocks until something is enqueued, well past the point where it stops spinning.
+bool blocks_when_empty(){
+	lf_queue<int> queue(8);
+	std::atomic<int> got(-1);
+	std::thread consumer([&](){
+		int value;
+		if(queue.dequeue(value)){
+			got.store(value);
+		}
+	});
+	
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	bool blocked = got.load() == -1;
+	queue.enqueue(7);
+	
+	testing_clock::time_point deadline = testing_clock::now() + std::chrono::seconds(1);
+	while(got.load() == -1 && testing_clock::now() < deadline){
+		std::this_thread::yield();
+	}
+	bool woken = got.load() == 7;
+	if(!woken){
+		queue.close();		//So the join below doesn't hang.
+	}
+	consumer.join();
+	return blocked && woken;
+}
+
+//Closing wakes every blocked dequeue, which then fails.  Whatever was queued before the close still comes out first,
+//and nothing more goes in.
+bool close_wakes_consumers(){
+	lf_queue<int> queue(8);
+	std::atomic<int> failed(0);
+	std::vector<std::thread> consumers;
+	for(int i = 0; i < 4; ++i){
+		consumers.push_back(std::thread([&](){
+			int value;
+			if(!queue.dequeue(value)){
+				failed.fetch_add(1);
+			}
+		}));
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	queue.close();
+	for(auto i = consumers.begin(); i != consumers.end(); ++i){
+		i->join();
+	}
+	if(failed.load() != 4 || queue.enqueue(1)){
+		return false;
+	}
+	
+	lf_queue<int> draining(8);
+	draining.enqueue(1);
+	draining.enqueue(2);
+	draining.close();
+	int first, second, third;
+	return draining.dequeue(first) && first == 1 && draining.dequeue(second) && second == 2 && !draining.dequeue(third);
+}
+
+//The ring can't grow, so there's no unbounded lf_queue, and one with no room never accepts anything.
+bool capacity(){
+	bool threw = false;
+	try{
+		lf_queue<int> unbounded(-1);
+	}catch(const std::invalid_argument&){
+		threw = true;
+	}
+	
+	lf_queue<int> none(0);
+	none.close();
+	int value;
+	return threw && !none.enqueue(1) && !none.dequeue(value);
+}
+
+bool run(const std::string& name, bool (*test)()){
+	bool passed = test();
+	std::cout << "(" << name << ") " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+int main(){
+	bool passed = true;
+	passed = run("mpmc", mpmc) && passed;
+	passed = run("full", full) && passed;
+	passed = run("blocks_when_empty", blocks_when_empty) && passed;
+	passed = run("close_wakes_consumers", close_wakes_consumers) && passed;
+	passed = run("capacity", capacity) && passed;
+	return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <iostream>
+#include "cpp/shared/semaphore.hpp"
+
+/*
+ * Regression tests for semaphore.  Exits non-zero if any of them fail.
+ * Build with -fsanitize=address (or thread) for destroyed_after_wait to catch anything, since a use after free doesn't crash by itself.
+ */
+
+typedef std::chrono::steady_clock testing_clock;
+
+//The waiter destroys the semaphore as soon as its wait returns, while the signaller may still be inside signal().
+//This is the barbershop's customer/barber hand-off.
+bool destroyed_after_wait(){
+	for(int round = 0; round < 2000; ++round){
+		semaphore* sem = new semaphore(0);
+		std::atomic<semaphore*> handoff(nullptr);
+		std::thread signaller([&](){
+			semaphore* s;
+			while((s = handoff.load()) == nullptr){
+				std::this_thread::yield();
+			}
+			if(round % 8 == 0){
+				std::this_thread::sleep_for(std::chrono::microseconds(500));		//Long enough for the waiter to fall asleep.
+			}
+			s->signal();
+		});
+		handoff.store(sem);
+		sem->wait();
+		delete sem;
+		signaller.join();
+	}
+	return true;
+}
+
+//Counted and single waiters asleep together all get through once there are enough permits.
+bool mixed_waiters(){
+	semaphore sem(0);
+	std::vector<std::thread> waiters;
+	for(int i = 0; i < 4; ++i){
+		waiters.push_back(std::thread([&](){sem.wait(3);}));
+		waiters.push_back(std::thread([&](){sem.wait();}));
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	for(int i = 0; i < 16; ++i){
+		sem.signal();
+	}
+	for(auto i = waiters.begin(); i != waiters.end(); ++i){
+		i->join();
+	}
+	return !sem.try_wait();
+}
+
+//Single signals trickle in while lots of waiters are asleep.  Each one has to let exactly one waiter through, and none of them can get lost.
+bool single_signals(){
+	constexpr int waiters = 32;
+	semaphore sem(0);
+	std::atomic<int> through(0);
+	std::vector<std::thread> threads;
+	for(int i = 0; i < waiters; ++i){
+		threads.push_back(std::thread([&](){
+			sem.wait();
+			through.fetch_add(1);
+		}));
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	
+	bool passed = true;
+	for(int i = 1; i <= waiters && passed; ++i){
+		sem.signal();
+		testing_clock::time_point deadline = testing_clock::now() + std::chrono::seconds(1);
+		while(through.load() < i && testing_clock::now() < deadline){
+			std::this_thread::yield();
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));		//Gives anyone let through by mistake time to show up.
+		passed = through.load() == i;
+	}
+	if(!passed){
+		sem.signal(waiters);		//So the joins below don't hang.
+	}
+	for(auto i = threads.begin(); i != threads.end(); ++i){
+		i->join();
+	}
+	return passed;
+}
+
+//A timed wait wakes up when signalled, rather than on its next poll, and gives up on time when it isn't.
+bool timed_waits(){
+	semaphore sem(0);
+	
+	testing_clock::time_point start = testing_clock::now();
+	bool acquired = sem.wait_for(std::chrono::milliseconds(20));
+	auto waited = testing_clock::now() - start;
+	if(acquired || waited < std::chrono::milliseconds(20) || waited > std::chrono::milliseconds(200)){
+		return false;
+	}
+	
+	std::atomic<long long> woken_after(-1);
+	std::thread waiter([&](){
+		testing_clock::time_point begin = testing_clock::now();
+		if(sem.wait_for(std::chrono::seconds(10))){
+			woken_after.store(std::chrono::duration_cast<std::chrono::microseconds>(testing_clock::now() - begin).count());
+		}
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	sem.signal();
+	waiter.join();
+	return woken_after.load() >= 0 && woken_after.load() < 50000 + 20000;
+}
+
+bool run(const std::string& name, bool (*test)()){
+	bool passed = test();
+	std::cout << "(" << name << ") " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+int main(){
+	bool passed = true;
+	passed = run("destroyed_after_wait", destroyed_after_wait) && passed;
+	passed = run("mixed_waiters", mixed_waiters) && passed;
+	passed = run("single_signals", single_signals) && passed;
+	passed = run("timed_waits", timed_waits) && passed;
+	return passed ? 0 : 1;
+}
\ No newline at end of file
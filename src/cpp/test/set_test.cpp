@@ -0,0 +1,225 @@
+#include <set>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+#include "cpp/shared/lf_list.hpp"
+#include "cpp/shared/fine_list.hpp"
+#include "cpp/shared/shard_set.hpp"
+#include "cpp/shared/skip_list.hpp"
+
+/*
+ * Consistency tests for the concurrent set backends.  Exits non-zero if any of them fail.
+ * Build with -fsanitize=thread (or address) too, since most of what can go wrong here is a race rather than a wrong answer.
+ */
+
+/*
+ * xorshift64*, so every thread has its own random numbers.  Only the high half gets used: the low bits of one plain xorshift64
+ * value give away the low bits of the next, which would tie each key to always being inserted or always being removed.
+ */
+std::uint64_t next_random(std::uint64_t& state){
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return (state * 0x2545f4914f6cdd1dULL) >> 32;
+}
+
+//One thread, random operations checked one by one against std::set, then a look at every key.
+template <class Set>
+bool sequential(){
+	constexpr int keys = 2000;
+	Set set;
+	std::set<int> model;
+	std::uint64_t state = 1;
+	for(int i = 0; i < 100000; ++i){
+		int key = next_random(state) % keys;
+		int roll = next_random(state) % 3;
+		bool expected;
+		bool got;
+		if(roll == 0){
+			expected = model.count(key) != 0;
+			got = set.contains(key);
+		}else if(roll == 1){
+			expected = model.insert(key).second;
+			got = set.insert(key);
+		}else{
+			expected = model.erase(key) != 0;
+			got = set.remove(key);
+		}
+		if(got != expected){
+			return false;
+		}
+	}
+	
+	for(int key = 0; key < keys; ++key){
+		if(set.contains(key) != (model.count(key) != 0)){
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * Every thread works on keys of its own, interleaved with everyone else's, so each one knows exactly what every answer should be
+ * while the others are changing the elements all around its own.  Afterwards every key has to match whoever owned it.
+ */
+template <class Set>
+bool disjoint_keys(){
+	constexpr int threads = 4;
+	constexpr int keys = 4000;
+	constexpr int operations = 20000;
+	Set set;
+	std::vector<std::vector<char>> models(threads, std::vector<char>(keys, 0));
+	std::atomic<bool> passed(true);
+	
+	std::vector<std::thread> workers;
+	for(int t = 0; t < threads; ++t){
+		workers.push_back(std::thread([&, t](){
+			std::vector<char>& model = models[t];
+			std::uint64_t state = t + 1;
+			for(int i = 0; i < operations; ++i){
+				int key = next_random(state) % (keys / threads) * threads + t;
+				int roll = next_random(state) % 3;
+				bool ok;
+				if(roll == 0){
+					ok = set.contains(key) == (model[key] != 0);
+				}else if(roll == 1){
+					ok = set.insert(key) == (model[key] == 0);
+					model[key] = 1;
+				}else{
+					ok = set.remove(key) == (model[key] != 0);
+					model[key] = 0;
+				}
+				if(!ok){
+					passed.store(false);
+				}
+			}
+		}));
+	}
+	for(auto i = workers.begin(); i != workers.end(); ++i){
+		i->join();
+	}
+	
+	for(int key = 0; key < keys; ++key){
+		if(set.contains(key) != (models[key % threads][key] != 0)){
+			return false;
+		}
+	}
+	return passed.load();
+}
+
+/*
+ * Every thread fights over the same few keys, so nobody can predict any one answer.  What they can't get wrong is the tally:
+ * for each key, the inserts that worked minus the removes that worked has to come out as whether it's in the set at the end.
+ */
+template <class Set>
+bool shared_keys(){
+	constexpr int threads = 4;
+	constexpr int keys = 64;
+	constexpr int operations = 20000;
+	Set set;
+	std::vector<std::atomic<int>> tally(keys);
+	
+	std::vector<std::thread> workers;
+	for(int t = 0; t < threads; ++t){
+		workers.push_back(std::thread([&, t](){
+			std::uint64_t state = t + 1;
+			for(int i = 0; i < operations; ++i){
+				int key = next_random(state) % keys;
+				int roll = next_random(state) % 3;
+				if(roll == 0){
+					set.contains(key);
+				}else if(roll == 1){
+					tally[key].fetch_add(set.insert(key));
+				}else{
+					tally[key].fetch_sub(set.remove(key));
+				}
+			}
+		}));
+	}
+	for(auto i = workers.begin(); i != workers.end(); ++i){
+		i->join();
+	}
+	
+	for(int key = 0; key < keys; ++key){
+		if(tally[key].load() != (set.contains(key) ? 1 : 0)){
+			return false;
+		}
+	}
+	return true;
+}
+
+//Only two shards, so every shard rehashes over and over as it grows.
+struct two_shard_set : shard_set<int>{
+	two_shard_set() : shard_set<int>(2) {}
+};
+
+//Eight keys in a row share a hash, so they pile up in one long probe run.
+struct clustered_hash{
+	std::size_t operator()(int x) const {return x / 8;}
+};
+
+/*
+ * Churns shard_set's probe runs against std::set: every removal either leaves a tombstone or (with an empty slot right after it)
+ * empties its slot, and a slot emptied in the middle of a run would cut off the keys past it.  The tombstones pile up
+ * until they force rehashes too.  Every key (and the size) is checked every so often, not just the ones being touched.
+ */
+bool shard_set_probe_runs(){
+	constexpr int keys = 512;
+	shard_set<int, clustered_hash> set(2);
+	std::set<int> model;
+	std::uint64_t state = 1;
+	for(int i = 0; i < 200000; ++i){
+		int key = next_random(state) % keys;
+		bool ok;
+		if(next_random(state) % 2 == 0){
+			ok = set.insert(key) == model.insert(key).second;
+		}else{
+			ok = set.remove(key) == (model.erase(key) != 0);
+		}
+		if(!ok){
+			return false;
+		}
+		
+		if(i % 1000 == 0){
+			for(int k = 0; k < keys; ++k){
+				if(set.contains(k) != (model.count(k) != 0)){
+					return false;
+				}
+			}
+			if(set.size() != model.size()){
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool run(const std::string& name, bool (*test)()){
+	bool passed = test();
+	std::cout << "(" << name << ") " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+int main(){
+	bool passed = true;
+	passed = run("lf_list sequential", sequential<lf_list<int>>) && passed;
+	passed = run("lf_list disjoint_keys", disjoint_keys<lf_list<int>>) && passed;
+	passed = run("lf_list shared_keys", shared_keys<lf_list<int>>) && passed;
+	passed = run("coupled_list sequential", sequential<coupled_list<int>>) && passed;
+	passed = run("coupled_list disjoint_keys", disjoint_keys<coupled_list<int>>) && passed;
+	passed = run("coupled_list shared_keys", shared_keys<coupled_list<int>>) && passed;
+	passed = run("lazy_list sequential", sequential<lazy_list<int>>) && passed;
+	passed = run("lazy_list disjoint_keys", disjoint_keys<lazy_list<int>>) && passed;
+	passed = run("lazy_list shared_keys", shared_keys<lazy_list<int>>) && passed;
+	passed = run("skip_list sequential", sequential<skip_list<int>>) && passed;
+	passed = run("skip_list disjoint_keys", disjoint_keys<skip_list<int>>) && passed;
+	passed = run("skip_list shared_keys", shared_keys<skip_list<int>>) && passed;
+	passed = run("shard_set sequential", sequential<shard_set<int>>) && passed;
+	passed = run("shard_set disjoint_keys", disjoint_keys<two_shard_set>) && passed;
+	passed = run("shard_set shared_keys", shared_keys<shard_set<int>>) && passed;
+	passed = run("shard_set probe_runs", shard_set_probe_runs) && passed;
+	return passed ? 0 : 1;
+}
\ No newline at end of file
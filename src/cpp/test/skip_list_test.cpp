@@ -0,0 +1,103 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include <iostream>
+#include "cpp/shared/skip_list.hpp"
+
+/*
+ * Tests for skip_list::range.  Exits non-zero if any of them fail.
+ * Build with -fsanitize=thread (or address) too, since scans and writers touching the same nodes is the point.
+ */
+
+//A scan of a quiet list gets exactly the elements in [lo, hi], in order.
+bool quiet_range(){
+	skip_list<int> list;
+	for(int i = 0; i < 1000; i += 3){
+		list.insert(i);
+	}
+	
+	std::vector<int> seen;
+	list.range(100, 200, [&](int x){seen.push_back(x);});
+	std::vector<int> expected;
+	for(int i = 102; i <= 200; i += 3){
+		expected.push_back(i);
+	}
+	
+	int none = 0;
+	list.range(1000, 2000, [&](int){++none;});
+	list.range(50, 40, [&](int){++none;});
+	return seen == expected && none == 0;
+}
+
+/*
+ * Scans run while writers churn through the odd numbers.  The even numbers are never touched, so every scan has to see all of them,
+ * and whatever it sees has to be strictly increasing and within its bounds.
+ */
+bool concurrent_range(){
+	constexpr int keys = 4096;
+	skip_list<int> list;
+	for(int i = 0; i < keys; i += 2){
+		list.insert(i);
+	}
+	
+	std::atomic<bool> stop(false);
+	std::atomic<int> rounds(0);
+	std::vector<std::thread> writers;
+	for(int w = 0; w < 3; ++w){
+		writers.push_back(std::thread([&, w](){
+			for(int round = 0; !stop.load(); ++round){
+				for(int i = 1 + 2 * w; i < keys; i += 6){
+					if(round % 2 == 0){
+						list.insert(i);
+					}else{
+						list.remove(i);
+					}
+				}
+				rounds.fetch_add(1);
+			}
+		}));
+	}
+	
+	while(rounds.load() == 0){
+		std::this_thread::yield();
+	}
+	bool passed = true;
+	for(int scan = 0; (scan < 2000 || rounds.load() < 20) && passed; ++scan){		//Enough scans that plenty of writes land during them.
+		std::this_thread::yield();
+		int lo = (scan * 37) % keys;
+		int hi = lo + 500;
+		int previous = lo - 1;
+		int evens = 0;
+		list.range(lo, hi, [&](int x){
+			if(x <= previous || x < lo || x > hi){
+				passed = false;
+			}
+			previous = x;
+			evens += x % 2 == 0;
+		});
+		int last = hi < keys ? hi : keys - 1;
+		if(evens != last / 2 - (lo + 1) / 2 + 1){
+			passed = false;
+		}
+	}
+	
+	stop.store(true);
+	for(auto i = writers.begin(); i != writers.end(); ++i){
+		i->join();
+	}
+	return passed;
+}
+
+bool run(const std::string& name, bool (*test)()){
+	bool passed = test();
+	std::cout << "(" << name << ") " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+int main(){
+	bool passed = true;
+	passed = run("quiet_range", quiet_range) && passed;
+	passed = run("concurrent_range", concurrent_range) && passed;
+	return passed ? 0 : 1;
+}
\ No newline at end of file